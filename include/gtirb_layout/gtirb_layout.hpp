@@ -17,6 +17,25 @@
 
 #include "Export.hpp"
 #include <gtirb/gtirb.hpp>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_set>
+
+namespace gtirb {
+namespace schema {
+
+/// \brief Auxiliary data caching the result of
+/// \ref gtirb_layout::cacheLayoutHealth: whether the module needs a new
+/// layout, and its numbers of unaddressed sections, overlaps and integral
+/// symbols.
+struct LayoutHealth {
+  static constexpr const char* Name = "layoutHealth";
+  typedef std::tuple<bool, uint64_t, uint64_t, uint64_t> Type;
+};
+
+} // namespace schema
+} // namespace gtirb
 
 namespace gtirb_layout {
 
@@ -34,15 +53,69 @@ bool GTIRB_LAYOUT_EXPORT_API layoutRequired(gtirb::IR& Ir);
 /// Determine whether any ByteIntervals in the Module require new addresses
 /// before it can be printed.
 ///
-/// \param M  Module to check.
+/// \param M             Module to check.
+/// \param SkipSections  Names of sections to ignore.
 ///
 /// \return \c true if the Module cannot be pretty printed.
-bool GTIRB_LAYOUT_EXPORT_API layoutRequired(
-    gtirb::Module& M, std::unordered_set<std::string> SkipSections = {});
+bool GTIRB_LAYOUT_EXPORT_API
+layoutRequired(gtirb::Module& M,
+               const std::unordered_set<std::string>& SkipSections = {});
+
+/// Summary of the state of a Module's layout, as computed by
+/// \ref checkLayout.
+struct LayoutHealth {
+  /// The Module cannot be pretty printed without a new layout.
+  bool LayoutRequired = false;
+  /// Number of sections without an address.
+  size_t UnaddressedSections = 0;
+  /// Number of adjacent sections, or adjacent ByteIntervals in a section,
+  /// that overlap.
+  size_t Overlaps = 0;
+  /// Number of symbols with an address but no referent.
+  size_t IntegralSymbols = 0;
+};
+
+/// Summarize the layout of a Module in a single pass over its sections and
+/// symbols.
+///
+/// Unlike \ref layoutRequired, this does not stop at the first problem, so
+/// callers can compute it once and reuse it for every later decision that
+/// depends on the layout.
+///
+/// \param M             Module to check.
+/// \param SkipSections  Names of sections to ignore.
+///
+/// \return the layout summary of the Module.
+LayoutHealth GTIRB_LAYOUT_EXPORT_API
+checkLayout(const gtirb::Module& M,
+            const std::unordered_set<std::string>& SkipSections = {});
+
+/// Compute \ref checkLayout for a Module and cache the result on it, in the
+/// \c layoutHealth AuxData table, for later passes to reuse.
+///
+/// The cached result is dropped by \ref fixIntegralSymbols, and so by every
+/// function in this file that changes the layout of the Module.
+///
+/// \param M             Module to check.
+/// \param SkipSections  Names of sections to ignore.
+///
+/// \return the layout summary of the Module.
+LayoutHealth GTIRB_LAYOUT_EXPORT_API
+cacheLayoutHealth(gtirb::Module& M,
+                  const std::unordered_set<std::string>& SkipSections = {});
+
+/// Get the layout summary cached on a Module by \ref cacheLayoutHealth.
+///
+/// \param M  Module to get the summary of.
+///
+/// \return the cached layout summary, or \c std::nullopt if there is none.
+std::optional<LayoutHealth>
+    GTIRB_LAYOUT_EXPORT_API getCachedLayoutHealth(const gtirb::Module& M);
 
 /// Assigns referents to every integral symbol that preserve the symbol's
 /// address. If a block does not exist at the required address, a new block
 /// will be created.
+/// Drops the layout summary cached on the module, if any.
 ///
 /// \param Ctx  Context to create new blocks in.
 /// \param M    Module containing symbols to modify.
@@ -53,6 +126,32 @@ void GTIRB_LAYOUT_EXPORT_API fixIntegralSymbols(gtirb::Context& Ctx,
 bool GTIRB_LAYOUT_EXPORT_API layoutModule(gtirb::Context& Ctx,
                                           gtirb::Module& M);
 
+/// Assigns addresses to byte intervals in every module of the IR, as
+/// \ref layoutModule does for each of them. Modules are laid out concurrently.
+///
+/// \param Ctx  Context to use for \c fixIntegralSymbols.
+/// \param Ir   IR whose modules to lay out.
+///
+/// \return \c true.
+bool GTIRB_LAYOUT_EXPORT_API layoutModules(gtirb::Context& Ctx, gtirb::IR& Ir);
+
+/// Assigns addresses to byte intervals in the module to make it printable,
+/// keeping the addresses of sections that do not need to move.
+///
+/// Sections are kept, in address order, up to the first one that overlaps an
+/// earlier section or whose byte intervals overlap each other. That section,
+/// every section after it, and every section without an address are laid out
+/// again after the kept sections, as \ref layoutModule would lay them out.
+///
+/// \param Ctx             Context to use for \c fixIntegralSymbols.
+/// \param M               Module to lay out.
+/// \param MovedIntervals  If not null, set to the number of byte intervals
+///                        whose address changed.
+///
+/// \return \c true.
+bool GTIRB_LAYOUT_EXPORT_API layoutModuleIncremental(
+    gtirb::Context& Ctx, gtirb::Module& M, size_t* MovedIntervals = nullptr);
+
 /// Removes addresses from the byte intervals in a module. Automatically calls
 /// \ref fixIntegralSymbols to ensure symbols remain linked to the byte
 /// intervals after their addresses change.
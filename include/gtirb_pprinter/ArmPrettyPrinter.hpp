@@ -17,6 +17,10 @@
 
 #include "ElfPrettyPrinter.hpp"
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace gtirb_pprint {
 
 class ArmSyntax : public ElfSyntax {
@@ -43,6 +47,24 @@ private:
   const std::string AttributePrefix{"%"};
 };
 
+/// Capstone modes to try, in order, when decoding ARM or Thumb blocks.
+///
+/// Modes matching the architecture version and profile in the `archInfo'
+/// AuxData table come first, so that blocks of a module with `archInfo' decode
+/// on the first attempt. Modes that match it equally well, or all modes if the
+/// table is missing, keep their default order. The order is fixed for the
+/// module, so a block decodes the same way whatever was printed before it.
+class DEBLOAT_PRETTYPRINTER_EXPORT_API ArmCsModeOrder {
+public:
+  ArmCsModeOrder(std::vector<size_t> Modes,
+                 const std::map<std::string, std::string>& ArchInfo);
+
+  const std::vector<size_t>& modes() const { return Modes; }
+
+private:
+  std::vector<size_t> Modes;
+};
+
 class ArmPrettyPrinter : public ElfPrettyPrinter {
 public:
   ArmPrettyPrinter(gtirb::Context& context, const gtirb::Module& module,
@@ -77,6 +99,10 @@ protected:
                             const gtirb::Symbol* symbol) override;
   void printSymExprSuffix(std::ostream& OS, const gtirb::SymAttributeSet& Attrs,
                           bool IsNotBranch = false) override;
+
+private:
+  ArmCsModeOrder ArmModes;
+  ArmCsModeOrder ThumbModes;
 };
 
 class ArmPrettyPrinterFactory : public ElfPrettyPrinterFactory {
@@ -106,6 +106,13 @@ struct BinaryType {
   typedef std::vector<std::string> Type;
 };
 
+/// \brief Auxiliary data describing the target architecture, e.g. the ARM
+/// architecture version ("Arch") and profile ("Profile").
+struct ArchInfo {
+  static constexpr const char* Name = "archInfo";
+  typedef std::map<std::string, std::string> Type;
+};
+
 /// \brief Auxiliary data representing the export table of a PE file.
 struct ExportEntries {
   static constexpr const char* Name = "peExportEntries";
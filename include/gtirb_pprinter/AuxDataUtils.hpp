@@ -30,6 +30,7 @@
  *          Libraries
  *          LibraryPaths
  *          BinaryType
+ *          ArchInfo
  *      pe:
  *          PeImportedSymbols
  *          PeExportedSymbols
@@ -204,6 +205,9 @@ getBinaryType(const gtirb::Module& Module);
 
 void setBinaryType(gtirb::Module& Module, const std::vector<std::string>& Vec);
 
+// Load the architecture description from the `archInfo' AuxData table.
+std::map<std::string, std::string> getArchInfo(const gtirb::Module& Module);
+
 // Load symbol forwarding mapping from the `symbolForwarding' AuxData table.
 std::map<gtirb::UUID, gtirb::UUID>
 getSymbolForwarding(const gtirb::Module& Module);
@@ -16,18 +16,35 @@
 #define GTIRB_PP_ELF_BINARY_PRINTER_H
 
 #include "BinaryPrinter.hpp"
+#include "ElfDummySOWriter.hpp"
 #include "FileUtils.hpp"
 
 #include <gtirb/gtirb.hpp>
 
+#include <map>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 /// \brief ElfBinary-print GTIRB representations.
 namespace gtirb_bprint {
 class TempFile;
 
-using SymbolGroup = std::vector<const gtirb::Symbol*>;
+/// Optional behavior of ElfBinaryPrinter; the defaults print as before.
+struct ElfBinaryPrinterOptions {
+  /// Directory in which assembled dummy .so libraries are cached across runs,
+  /// or empty not to cache them.
+  std::string DummySOCacheDir;
+  /// Write dummy .so libraries directly instead of assembling them. Only
+  /// used for x86-64 modules; other ISAs still assemble them.
+  bool NativeDummySO = false;
+  /// Write object files directly instead of assembling the printed module.
+  bool ObjectDirect = false;
+  /// Linker passed to the compiler with -fuse-ld, "auto" to pick a faster
+  /// one if available, or empty (or "default") for the compiler's default.
+  std::string Linker;
+};
 
 class DEBLOAT_PRETTYPRINTER_EXPORT_API ElfBinaryPrinter : public BinaryPrinter {
 private:
@@ -35,6 +52,15 @@ private:
   std::string compiler;
   bool debug = false;
   bool useDummySO = false;
+  bool useNativeDummySO = false;
+  bool useObjectDirect = false;
+  std::string DummySOCacheDir;
+  std::string Linker;
+  // --help output of each (compiler, linker) pair, or nullopt if the compiler
+  // cannot use the linker.
+  mutable std::map<std::pair<std::string, std::string>,
+                   std::optional<std::string>>
+      LinkerHelps;
   bool isInfixLibraryName(const std::string& library) const;
   std::optional<std::string>
   findLibrary(const std::string& library,
@@ -55,6 +81,10 @@ private:
   - elfSymbolInfo auxdata cannot be found for a symbol in syms
   - Symbols in the same SymbolGroup have inconsistent sizes
   - The compiler returned an error when building the dummy .so
+
+  If a dummy-so cache directory is configured, a library previously built
+  from the same assembly, version script, compiler, and architecture flags is
+  reused instead of invoking the compiler.
   */
   bool generateDummySO(const gtirb::Module& module, const std::string& libDir,
                        const std::string& lib,
@@ -67,8 +97,13 @@ private:
   Libraries are generated in the libDir directory. Appends compiler arguments
   to libArgs required for linking with the generated libraries.
 
+  Libraries are written directly by writeDummySO if native dummy-so generation
+  is enabled and the module is x86-64, and assembled by generateDummySO
+  otherwise. Only assembled libraries are cached.
+
   Returns true on success, or false if:
-  - generateDummySO fails (see its docstring for failure reasons)
+  - generateDummySO or writeDummySO fails (see their docstrings for failure
+    reasons)
   - There are no dynamic libraries needed
   - Symbols in the same group have conflicting elfSymbolVersionInfo
   - There are not enough external symbols to generate all of the dynamically
@@ -78,9 +113,39 @@ private:
                           const gtirb::Module& module,
                           const std::string& libDir,
                           std::vector<std::string>& libArgs) const;
+
+  /**
+  Write the module directly as a relocatable object file into ObjectFile,
+  without invoking the assembler.
+
+  Returns false if the module cannot be written directly (see
+  PrettyPrinter::writeObject); the caller should then fall back to assembling
+  the pretty-printed module.
+  */
+  bool prepareObject(gtirb::Context& Context, gtirb::Module& Module,
+                     TempFile& ObjectFile) const;
   void addOrigLibraryArgs(const gtirb::Module& module,
                           std::vector<std::string>& args,
                           const std::string& location) const;
+
+  /**
+  Select the linker requested with the linker option and adapt the linker
+  flags in Args to it.
+
+  The linker is either named explicitly (e.g. "mold", "lld", "gold") or
+  detected with "auto", which tries mold and then lld. A candidate is used
+  only if the compiler accepts it with -fuse-ld and its --help output lists
+  every linker option in Args; otherwise Args is left unchanged and the
+  compiler's default linker is used.
+  */
+  void useLinker(std::vector<std::string>& Args) const;
+
+  /**
+  Return the --help output of Candidate as run by the compiler with -fuse-ld,
+  or nullopt if that fails. The result is cached for the printer's lifetime.
+  */
+  const std::optional<std::string>&
+  getLinkerHelp(const std::string& Candidate) const;
   std::vector<std::string>
   buildCompilerArgs(std::string outputFilename,
                     const std::vector<TempFile>& asmPath, gtirb::Module& module,
@@ -92,10 +157,14 @@ public:
                             const std::string& gccExecutable,
                             const std::vector<std::string>& extraCompileArgs,
                             const std::vector<std::string>& libraryPaths,
-                            bool debugFlag, bool dummySOFlag)
+                            bool debugFlag, bool dummySOFlag,
+                            const ElfBinaryPrinterOptions& Options = {})
       : BinaryPrinter(prettyPrinter, extraCompileArgs, libraryPaths),
         compiler(gccExecutable.empty() ? defaultCompiler : gccExecutable),
-        debug(debugFlag), useDummySO(dummySOFlag) {}
+        debug(debugFlag), useDummySO(dummySOFlag),
+        useNativeDummySO(Options.NativeDummySO),
+        useObjectDirect(Options.ObjectDirect),
+        DummySOCacheDir(Options.DummySOCacheDir), Linker(Options.Linker) {}
   virtual ~ElfBinaryPrinter() = default;
 
   int assemble(const std::string& outputFilename, gtirb::Context& context,
@@ -0,0 +1,58 @@
+//===- ElfDummySOWriter.hpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ELF_DUMMY_SO_WRITER_H
+#define GTIRB_PP_ELF_DUMMY_SO_WRITER_H
+
+#include "Export.hpp"
+
+#include <gtirb/gtirb.hpp>
+
+#include <string>
+#include <vector>
+
+namespace gtirb_bprint {
+
+/// Symbols that must refer to the same location in a dummy library.
+using SymbolGroup = std::vector<const gtirb::Symbol*>;
+
+/**
+Write a dummy stand-in shared object directly, without invoking a compiler.
+
+The library contains a dynamic symbol table, version definitions, a dynamic
+section, and zero-filled .text, .data, and .tdata placeholders sized after the
+symbols in SymGroups. Symbols in a group together refer to the same location.
+
+SoName is recorded as the library's DT_SONAME. Symbol versions are omitted if
+IgnoreSymbolVersions is set.
+
+Supports the IA32, X64, ARM, ARM64, and MIPS32 ISAs. ElfBinaryPrinter only
+uses it for X64, the one whose output has been linked and run so far.
+
+Returns true on success, or false if:
+- The module's ISA is not supported
+- elfSymbolInfo auxdata cannot be found for a symbol in SymGroups
+- Symbols in the same SymbolGroup have inconsistent sizes
+- A symbol has an unknown type
+- The file at Path cannot be written
+*/
+DEBLOAT_PRETTYPRINTER_EXPORT_API bool
+writeDummySO(const gtirb::Module& Module, const std::string& Path,
+             const std::string& SoName,
+             const std::vector<SymbolGroup>& SymGroups,
+             bool IgnoreSymbolVersions);
+
+} // namespace gtirb_bprint
+
+#endif /* GTIRB_PP_ELF_DUMMY_SO_WRITER_H */
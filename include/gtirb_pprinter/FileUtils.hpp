@@ -70,8 +70,41 @@ std::optional<std::string> resolveRegularFilePath(const std::string& path,
 std::optional<int> execute(const std::string& tool,
                            const std::vector<std::string>& args);
 
+// Same as above, but also collects the standard output of the tool into
+// Output. The standard error of the tool is discarded.
+std::optional<int> execute(const std::string& tool,
+                           const std::vector<std::string>& args,
+                           std::string& Output);
+
 // Helper function to copy files, creating parent directories as needed
 void copyFile(const std::string& src, const std::string& dest);
 
+/// Auxiliary class to manage a persistent directory of build artifacts, keyed
+/// by a hash of everything that went into building them.
+class FileCache {
+  std::string Dir;
+
+public:
+  explicit FileCache(const std::string& Dir);
+
+  // Compute a cache key from the inputs that determine an artifact's content.
+  static std::string key(const std::vector<std::string>& Inputs);
+
+  // Compute a cache key from the contents of the file at Path. Returns nullopt
+  // if the file cannot be read.
+  static std::optional<std::string> fileKey(const std::string& Path);
+
+  // Place the artifact cached under Key at Dest, hard-linking it if Link is
+  // set and possible, and copying it otherwise. A hard link shares the cached
+  // file, so only link to a Dest that is neither modified nor handed to the
+  // user. Returns false if there is no such artifact.
+  bool fetch(const std::string& Key, const std::string& Dest,
+             bool Link = true) const;
+
+  // Add the file at Src to the cache under Key. Failing to store an artifact
+  // is not an error; it only costs a cache miss on a later run.
+  void store(const std::string& Key, const std::string& Src) const;
+};
+
 } // namespace gtirb_bprint
 #endif /* GTIRB_FileUtils_H */
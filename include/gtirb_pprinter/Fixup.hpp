@@ -15,6 +15,7 @@
 #ifndef GT_PPRINTER_FIXUP_H
 #define GT_PPRINTER_FIXUP_H
 #include "Export.hpp"
+#include <string>
 
 namespace gtirb {
 class Context;
@@ -38,11 +39,26 @@ void DEBLOAT_PRETTYPRINTER_EXPORT_API applyFixups(gtirb::Context& Ctx,
                                                   gtirb::Module& Mod,
                                                   const PrettyPrinter& Printer);
 
+/// Same as above, but saves the edits of the shared-object fixup in CacheDir,
+/// and reuses them instead of scanning the module again on later runs.
+/// \param Key  Identifies the contents of the module before the fixups, e.g.
+/// a hash of the IR file and of the layout applied to it.
+void DEBLOAT_PRETTYPRINTER_EXPORT_API applyFixups(gtirb::Context& Ctx,
+                                                  gtirb::Module& Mod,
+                                                  const PrettyPrinter& Printer,
+                                                  const std::string& CacheDir,
+                                                  const std::string& Key);
+
 /// Turn any direct references to global symbols, which
 /// are illegal relocations in shared objects, into
 /// indirect references
 void fixupSharedObject(gtirb::Context& Ctx, gtirb::Module& Mod);
 
+/// Same as above, but reuses the edits cached in CacheDir under Key if there
+/// are any, and caches them otherwise.
+void fixupSharedObject(gtirb::Context& Ctx, gtirb::Module& Mod,
+                       const std::string& CacheDir, const std::string& Key);
+
 /// Ensure that PE entry symbols are correctly named
 void fixupPESymbols(gtirb::Context& Ctx, gtirb::Module& Mod);
 
@@ -151,6 +151,7 @@ protected:
                                bool inData = false) override;
 
   void printByte(std::ostream& os, std::byte byte) override;
+  void printByteRun(std::ostream& os, std::byte byte, uint64_t Count) override;
   void printZeroDataBlock(std::ostream& os, const gtirb::DataBlock& dataObject,
                           uint64_t offset) override;
 
@@ -0,0 +1,189 @@
+//===- Parallel.hpp ---------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_PARALLEL_H
+#define GTIRB_PP_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace gtirb_pprint {
+
+/// \brief Number of worker threads to use for \p Tasks independent tasks.
+///
+/// The pool is bounded by the hardware concurrency of the host and never
+/// exceeds the number of tasks.
+inline size_t workerCount(size_t Tasks) {
+  size_t Workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+  return std::max<size_t>(1, std::min(Workers, Tasks));
+}
+
+/// \brief Call \p F with every index in [0, \p Count) on a bounded pool of
+/// worker threads.
+///
+/// Indices are handed out dynamically, so tasks of uneven cost balance across
+/// the workers. All tasks run to completion even if one of them throws; the
+/// first exception is rethrown on the calling thread once the pool has
+/// drained.
+template <typename Fn> void parallelFor(size_t Count, Fn&& F) {
+  size_t Workers = workerCount(Count);
+  if (Workers <= 1) {
+    for (size_t I = 0; I < Count; ++I) {
+      F(I);
+    }
+    return;
+  }
+
+  std::atomic<size_t> Next{0};
+  std::exception_ptr Error;
+  std::mutex ErrorMutex;
+  auto Worker = [&]() {
+    for (size_t I = Next++; I < Count; I = Next++) {
+      try {
+        F(I);
+      } catch (...) {
+        std::lock_guard<std::mutex> Lock(ErrorMutex);
+        if (!Error) {
+          Error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  Threads.reserve(Workers - 1);
+  for (size_t I = 1; I < Workers; ++I) {
+    Threads.emplace_back(Worker);
+  }
+  Worker();
+  for (auto& Thread : Threads) {
+    Thread.join();
+  }
+  if (Error) {
+    std::rethrow_exception(Error);
+  }
+}
+
+/// \brief Call \p F with every task index of a dependency graph on a bounded
+/// pool of worker threads.
+///
+/// \p Dependencies holds, for each task, the indices of the tasks that must
+/// complete before it starts; a task may only depend on tasks with a lower
+/// index. \p F returns false if its task failed. Once a task fails (or
+/// throws), no further tasks are started, the running ones are allowed to
+/// finish, and the function returns false (or rethrows the first exception).
+/// Returns true if every task ran and succeeded.
+///
+/// At most \p Workers tasks run at once, including one on the calling thread.
+template <typename Fn>
+bool parallelForGraph(const std::vector<std::vector<size_t>>& Dependencies,
+                      Fn&& F, size_t Workers) {
+  size_t Count = Dependencies.size();
+  std::vector<size_t> Pending(Count);
+  std::vector<std::vector<size_t>> Dependents(Count);
+  std::deque<size_t> Ready;
+  for (size_t I = 0; I < Count; ++I) {
+    Pending[I] = Dependencies[I].size();
+    for (size_t D : Dependencies[I]) {
+      assert(D < I && "tasks may only depend on earlier tasks");
+      Dependents[D].push_back(I);
+    }
+    if (Pending[I] == 0) {
+      Ready.push_back(I);
+    }
+  }
+
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  size_t Running = 0;
+  bool Failed = false;
+  std::exception_ptr Error;
+  auto Worker = [&]() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true) {
+      Changed.wait(Lock,
+                   [&]() { return !Ready.empty() || Failed || Running == 0; });
+      if (Failed || Ready.empty()) {
+        // Either a task failed, or nothing is running that could make more
+        // tasks ready.
+        return;
+      }
+      size_t I = Ready.front();
+      Ready.pop_front();
+      ++Running;
+
+      Lock.unlock();
+      bool Succeeded = false;
+      try {
+        Succeeded = F(I);
+      } catch (...) {
+        Lock.lock();
+        if (!Error) {
+          Error = std::current_exception();
+        }
+        Lock.unlock();
+      }
+      Lock.lock();
+
+      --Running;
+      if (!Succeeded) {
+        Failed = true;
+      } else {
+        for (size_t Dependent : Dependents[I]) {
+          if (--Pending[Dependent] == 0) {
+            Ready.push_back(Dependent);
+          }
+        }
+      }
+      Changed.notify_all();
+    }
+  };
+
+  Workers = std::max<size_t>(1, Workers);
+  std::vector<std::thread> Threads;
+  Threads.reserve(Workers - 1);
+  for (size_t I = 1; I < Workers; ++I) {
+    Threads.emplace_back(Worker);
+  }
+  Worker();
+  for (auto& Thread : Threads) {
+    Thread.join();
+  }
+  if (Error) {
+    std::rethrow_exception(Error);
+  }
+  return !Failed;
+}
+
+/// \brief Call \p F with every task index of a dependency graph on a pool
+/// bounded like \link parallelFor.
+template <typename Fn>
+bool parallelForGraph(const std::vector<std::vector<size_t>>& Dependencies,
+                      Fn&& F) {
+  return parallelForGraph(Dependencies, std::forward<Fn>(F),
+                          workerCount(Dependencies.size()));
+}
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_PARALLEL_H */
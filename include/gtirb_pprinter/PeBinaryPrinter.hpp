@@ -29,9 +29,12 @@ class TempFile;
 
 class DEBLOAT_PRETTYPRINTER_EXPORT_API PeBinaryPrinter : public BinaryPrinter {
 public:
+  // If ImportLibCacheDir is not empty, import libraries are cached there and
+  // reused whenever their DEF file, target machine, and library tool match.
   PeBinaryPrinter(const gtirb_pprint::PrettyPrinter& Printer,
                   const std::vector<std::string>& ExtraCompileArgs,
-                  const std::vector<std::string>& LibraryPaths);
+                  const std::vector<std::string>& LibraryPaths,
+                  const std::string& ImportLibCacheDir = "");
 
   // Assemble a module but do not link the object.
   int assemble(const std::string& OutputFile, gtirb::Context& Context,
@@ -61,6 +64,9 @@ protected:
   bool prepareResources(const gtirb::Module& Module,
                         const gtirb::Context& Context,
                         std::vector<std::string>& Resources) const;
+
+private:
+  std::string ImportLibCacheDir;
 };
 
 } // namespace gtirb_bprint
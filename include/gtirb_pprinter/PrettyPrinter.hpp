@@ -31,6 +31,8 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -256,6 +258,15 @@ public:
   int print(std::ostream& Stream, gtirb::Context& Context,
             const gtirb::Module& Module) const;
 
+  /// Write the module directly as a relocatable object file, bypassing the
+  /// assembler. The current printing policy is applied as by \link print.
+  ///
+  /// Only x86-64 ELF modules can be written this way. Returns -1, after
+  /// logging the reason, if the module is not supported; the caller is
+  /// expected to fall back to printing and assembling it.
+  int writeObject(std::ostream& Stream, gtirb::Context& Context,
+                  const gtirb::Module& Module) const;
+
   PolicyOptions& functionPolicy() { return FunctionPolicy; }
   const PolicyOptions& functionPolicy() const { return FunctionPolicy; }
 
@@ -290,6 +301,7 @@ private:
   bool IgnoreSymbolVersions = false;
 
   PrettyPrinterFactory& getFactory(const gtirb::Module& Module) const;
+  PrintingPolicy resolvePolicy(const gtirb::Module& Module) const;
 };
 
 /// Abstract factory - encloses default printing configuration and a method for
@@ -351,6 +363,13 @@ protected:
 
   virtual std::string getRegisterName(unsigned int reg) const;
 
+  /// Return getRegisterName(Reg), computed once per register.
+  std::string_view getRegisterText(unsigned int Reg) const;
+
+  /// Return the lower-case mnemonic of Inst. The view is only valid until the
+  /// next call.
+  std::string_view getMnemonicText(const cs_insn& Inst);
+
   virtual void printBar(std::ostream& os, bool heavy = true);
   virtual void printHeader(std::ostream& os) = 0;
   virtual void printFooter(std::ostream& os) = 0;
@@ -388,6 +407,8 @@ protected:
                                   const gtirb::DataBlock& dataObject,
                                   uint64_t offset);
   virtual void printByte(std::ostream& os, std::byte byte) = 0;
+  // Print Count copies of byte as a single directive.
+  virtual void printByteRun(std::ostream& os, std::byte byte, uint64_t Count);
 
   virtual void fixupInstruction(cs_insn& inst);
 
@@ -450,6 +471,9 @@ protected:
                            bool first = false);
   virtual void printString(std::ostream& Stream, const gtirb::DataBlock& Block,
                            uint64_t Offset, bool NullTerminated = true) = 0;
+  // Return the number of bytes of Block, starting from its beginning, that
+  // can be read through Block.rawBytes(). The remaining bytes read as zero.
+  static uint64_t getInitializedBlockSize(const gtirb::DataBlock& Block);
 
   virtual void printOperand(std::ostream& os, const gtirb::CodeBlock& block,
                             const cs_insn& inst, uint64_t index);
@@ -488,9 +512,9 @@ protected:
       "Use getContainerFunctionSymbol instead.")]] std::optional<std::string>
   getContainerFunctionName(gtirb::Addr Addr) const;
   [[deprecated]] virtual std::string getFunctionName(gtirb::Addr x) const;
-  [[deprecated("Use attribute FunctionFirstBlocks instead.")]] bool
+  [[deprecated("Use isFirstBlockOfFunction instead.")]] bool
   isFunctionEntry(gtirb::Addr Addr) const;
-  [[deprecated("Use attribute FunctionLastBlocks instead.")]] bool
+  [[deprecated("Use isLastBlockOfFunction instead.")]] bool
   isFunctionLastBlock(gtirb::Addr Addr) const;
 
   virtual std::string getSymbolName(const gtirb::Symbol& symbol) const;
@@ -498,6 +522,14 @@ protected:
   getForwardedSymbolName(const gtirb::Symbol* symbol) const;
   virtual gtirb::Symbol* getForwardedSymbol(const gtirb::Symbol* Sym) const;
 
+  /// Return getSymbolName(Symbol), computed once per symbol and print.
+  const std::string& getSymbolText(const gtirb::Symbol& Symbol) const;
+
+  /// Return getForwardedSymbolName(Symbol), computed once per symbol and
+  /// print.
+  const std::optional<std::string>&
+  getForwardedSymbolText(const gtirb::Symbol* Symbol) const;
+
   virtual const gtirb::Symbol*
   getBestSymbol(const std::set<const gtirb::Symbol*, CmpSymPtr>& Symbols) const;
 
@@ -508,6 +540,43 @@ protected:
   uint64_t getSymbolicExpressionSize(
       const gtirb::ByteInterval::ConstSymbolicExpressionElement& SEE) const;
 
+  // A span of a data block that is printed with a single kind of directive.
+  struct DataRun {
+    enum class Kind {
+      Bytes,              // Printed one byte per line.
+      Repeat,             // Size copies of Value, printed with printByteRun.
+      SymbolicExpression, // The symbolic expression SEE.
+    };
+    Kind RunKind;
+    uint64_t Offset; // Relative to the start of the block.
+    uint64_t Size;
+    uint8_t Value = 0;
+    std::optional<gtirb::ByteInterval::ConstSymbolicExpressionElement> SEE;
+  };
+
+  // Runs of a repeated byte shorter than this are printed byte by byte.
+  static constexpr uint64_t MinDataRun = 16;
+
+  // Split a data block, from Offset on, into the runs it is printed as, in a
+  // single pass over its bytes and symbolic expressions.
+  std::vector<DataRun> classifyDataBlock(const gtirb::DataBlock& Block,
+                                         uint64_t Offset);
+
+  // Return the symbolic expression at address EA, which is usually within
+  // Block. The symbolic expressions of a code block are gathered into a
+  // sorted array the first time one of its operands is looked up, so that
+  // operand printing does not search the whole byte interval.
+  const gtirb::SymbolicExpression*
+  getSymbolicOperand(const gtirb::CodeBlock& Block, gtirb::Addr EA);
+
+  // Return the symbolic expressions of BI in [Low, High). Data blocks are
+  // printed in offset order, so this advances a cursor over the symbolic
+  // expressions of BI rather than searching for each block; the cursor is
+  // only repositioned by a search when BI changes or Low moves backwards.
+  gtirb::ByteInterval::const_symbolic_expression_range
+  symbolicExpressionsBetween(const gtirb::ByteInterval& BI, uint64_t Low,
+                             uint64_t High);
+
   std::optional<uint64_t> getAlignment(gtirb::Addr Addr) const;
 
   bool shouldSkip(const PrintingPolicy& Policy,
@@ -527,6 +596,25 @@ private:
   // When emitting end-of-line comments, what is the preferred (minimum) column
   // position to use?
   const size_t PreferredEOLCommentPos;
+  struct SymbolicExpressionCursor {
+    const gtirb::ByteInterval* BI = nullptr;
+    uint64_t Low = 0;
+    gtirb::ByteInterval::const_symbolic_expression_iterator It;
+    gtirb::ByteInterval::const_symbolic_expression_iterator End;
+  };
+  SymbolicExpressionCursor SymExprCursor;
+
+  // Symbolic expressions of the code block last passed to getSymbolicOperand,
+  // sorted by their offsets in its byte interval.
+  const gtirb::CodeBlock* OperandBlock = nullptr;
+  std::vector<uint64_t> OperandOffsets;
+  std::vector<const gtirb::SymbolicExpression*> OperandExpressions;
+
+  // Register names as printed by this syntax, filled in by getRegisterText.
+  // Node-based so views of existing entries survive later insertions.
+  mutable std::unordered_map<unsigned int, std::string> RegisterTexts;
+  char MnemonicText[CS_MNEMONIC_SIZE];
+
   gtirb_types::TypePrinter type_printer;
 
   template <typename BlockType>
@@ -539,6 +627,8 @@ private:
 
   /** Populate Function-related fields.*/
   void computeFunctionInformation();
+  /** Populate BlockAlignments and SymExprSizes. */
+  void computeAuxDataTables();
   /** Populate AmbiguousSymbols */
   void computeAmbiguousSymbols();
 
@@ -546,37 +636,59 @@ private:
    * This could return `nullptr` if the block does not belong to any function
    * or if the function does not have any symbol associated to it.*/
   const gtirb::Symbol*
-  getContainerFunctionSymbol(const gtirb::UUID& Uuid) const;
+  getContainerFunctionSymbol(const gtirb::Node& Block) const;
+  /** Return true if Block is the first block of some function.*/
+  bool isFirstBlockOfFunction(const gtirb::Node& Block) const;
+  /** Return true if Block is the last block of some function.*/
+  bool isLastBlockOfFunction(const gtirb::Node& Block) const;
 
   // A function is skipped if its name or any of its aliases are
   // in the function skip policy.
   bool isFunctionSkipped(const PrintingPolicy& Policy,
                          const gtirb::Symbol& FunctionSymbol) const;
 
-  /** Mapping from function UUIDs to the symbols that define the function
-   * name.*/
-  std::map<gtirb::UUID, const gtirb::Symbol*> FunctionToSymbols;
-  /** Mapping from Block UUIDs to Function UUIDs.*/
-  std::map<gtirb::UUID, gtirb::UUID> BlockToFunction;
-  /** Set of blocks that are the first in each function.*/
-  std::set<gtirb::UUID> FunctionFirstBlocks;
-  /** Set of block UUIDS that are the last in each function.*/
-  std::set<gtirb::UUID> FunctionLastBlocks;
+  /** Function information of a block listed in the functionBlocks table.*/
+  struct FunctionBlockInfo {
+    /** The symbol that defines the name of the block's function, or nullptr
+     * if the function has none.*/
+    const gtirb::Symbol* FunctionSymbol = nullptr;
+    /** Whether the block is the first block of some function.*/
+    bool First = false;
+    /** Whether the block is the last block of some function.*/
+    bool Last = false;
+  };
+  /** Function information of each block in the functionBlocks table, filled
+   * at construction. A single lookup per block answers every function query.*/
+  std::unordered_map<const gtirb::Node*, FunctionBlockInfo> FunctionBlockInfos;
 
 protected:
-  [[deprecated("Use FunctionFirstBlocks instead.")]] std::set<gtirb::Addr>
+  [[deprecated("Use isFirstBlockOfFunction instead.")]] std::set<gtirb::Addr>
       functionEntry;
-  [[deprecated("Use FunctionLastBlocks instead.")]] std::set<gtirb::Addr>
+  [[deprecated("Use isLastBlockOfFunction instead.")]] std::set<gtirb::Addr>
       functionLastBlock;
 
   /** The set of all symbols associated to a function.*/
   std::set<const gtirb::Symbol*> FunctionSymbols;
+  /** Alignment of each block from the `alignment' AuxData table, taken from
+   * the entry of the block or, for the first blocks of a byte interval or
+   * section, of the interval or section (see getAlignment).*/
+  std::unordered_map<const gtirb::Node*, uint64_t> BlockAlignments;
+  /** Sizes from the `symbolicExpressionSizes' AuxData table by byte
+   * interval, as (offset, size) pairs sorted by offset.*/
+  std::unordered_map<const gtirb::ByteInterval*,
+                     std::vector<std::pair<uint64_t, uint64_t>>>
+      SymExprSizes;
   /** Mapping from function names to aliases. These are computed depending on
    * the file format.*/
   std::map<const gtirb::Symbol*, std::set<const gtirb::Symbol*>>
       FunctionAliases;
 
   std::map<const gtirb::Symbol*, std::string> AmbiguousSymbols;
+  // Emitted symbol names, filled in by getSymbolText and
+  // getForwardedSymbolText and cleared when AmbiguousSymbols is recomputed.
+  mutable std::unordered_map<const gtirb::Symbol*, std::string> SymbolTexts;
+  mutable std::unordered_map<const gtirb::Symbol*, std::optional<std::string>>
+      ForwardedSymbolTexts;
   std::string m_accum_comment;
   static std::string s_symaddr_0_warning(uint64_t symAddr);
 };
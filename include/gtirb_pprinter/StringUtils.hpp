@@ -15,9 +15,51 @@
 #ifndef GTIRB_PP_StringUtils_H
 #define GTIRB_PP_StringUtils_H
 
+#include "Export.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
+#include <type_traits>
 
 std::string ascii_str_tolower(std::string s);
 std::string ascii_str_toupper(std::string s);
 
+// Return the number of leading bytes of [Data, Data + Size) that are neither
+// NUL nor one of the bytes escaped in assembler string literals (see
+// Syntax::escapeByte), i.e. that can be copied verbatim into a literal.
+DEBLOAT_PRETTYPRINTER_EXPORT_API size_t
+ascii_unescaped_prefix(const uint8_t* Data, size_t Size);
+
+// Return the number of leading bytes of [Data, Data + Size) that are
+// printable ASCII characters, as classified by std::isprint in the C locale.
+DEBLOAT_PRETTYPRINTER_EXPORT_API size_t
+ascii_printable_prefix(const uint8_t* Data, size_t Size);
+
+// Return the number of leading bytes of [Data, Data + Size) that are equal to
+// Value.
+DEBLOAT_PRETTYPRINTER_EXPORT_API size_t byte_run_length(const uint8_t* Data,
+                                                        size_t Size,
+                                                        uint8_t Value);
+
+// Write Value to OS in decimal, ignoring the stream's formatting flags.
+DEBLOAT_PRETTYPRINTER_EXPORT_API void write_signed_dec(std::ostream& OS,
+                                                       int64_t Value);
+DEBLOAT_PRETTYPRINTER_EXPORT_API void write_unsigned_dec(std::ostream& OS,
+                                                         uint64_t Value);
+
+template <typename T> void write_dec(std::ostream& OS, T Value) {
+  static_assert(std::is_integral_v<T>, "write_dec requires an integer");
+  if constexpr (std::is_signed_v<T>)
+    write_signed_dec(OS, Value);
+  else
+    write_unsigned_dec(OS, Value);
+}
+
+// Write Value to OS in lower-case hexadecimal, without a prefix and padded
+// with zeros to at least MinDigits digits, ignoring the stream's formatting
+// flags.
+DEBLOAT_PRETTYPRINTER_EXPORT_API void
+write_hex(std::ostream& OS, uint64_t Value, size_t MinDigits = 1);
+
 #endif /* GTIRB_PP_StringUtils_H */
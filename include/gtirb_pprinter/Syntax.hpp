@@ -71,6 +71,8 @@ public:
   virtual std::string formatFunctionName(const std::string& x) const;
   virtual std::string formatSymbolName(const std::string& x) const;
   virtual std::string avoidRegNameConflicts(const std::string& x) const;
+  // Only called for the bytes that ascii_unescaped_prefix stops at; all
+  // other bytes are copied into string literals as-is.
   virtual std::string escapeByte(uint8_t b) const;
   virtual std::optional<std::string> getSizeName(uint64_t bits) const;
 
@@ -7,47 +7,25 @@
 #include <gtirb_layout/gtirb_layout.hpp>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 namespace fs = boost::filesystem;
 namespace po = boost::program_options;
 
-int main(int argc, char** argv) {
-  gtirb_layout::registerAuxDataTypes();
-
-  po::options_description desc("gtirb-layout - layout code and data in memory "
-                               "without overlap.\n\n"
-                               "Allowed options");
-  desc.add_options()("help,h", "Produce this help message.");
-  desc.add_options()("in,i", po::value<std::string>()->required(),
-                     "Input GTIRB file.");
-  desc.add_options()("out,o", po::value<std::string>()->required(),
-                     "Output GTIRB file.");
-  desc.add_options()("remove,r", "Remove layout instead of adding it.");
-
-  po::positional_options_description pd;
-  pd.add("in", 1);
-  pd.add("out", 1);
-
-  po::variables_map vm;
-  try {
-    po::store(
-        po::command_line_parser(argc, argv).options(desc).positional(pd).run(),
-        vm);
-    if (vm.count("help") != 0) {
-      std::cout << desc << std::endl;
-      return EXIT_FAILURE;
-    }
-    po::notify(vm);
-  } catch (std::exception& e) {
-    LOG_ERROR << e.what() << ". Try '" << argv[0]
-              << " --help' for more information." << std::endl;
-    return EXIT_FAILURE;
-  }
+// Size of the stream buffers used to read and write GTIRB files. IR files are
+// large and written in many small pieces, so a large buffer saves system calls.
+static constexpr size_t StreamBufferSize = 1 << 20;
 
+// Lay out (or remove the layout of) one GTIRB file. Returns false, after
+// logging the reason, on failure.
+static bool processFile(const std::string& irString,
+                        const std::string& outString, bool remove) {
   gtirb::Context ctx;
   gtirb::IR* ir = nullptr;
+  std::vector<char> buffer(StreamBufferSize);
 
-  auto irString = vm["in"].as<std::string>();
   if (irString == "-") {
     if (gtirb::ErrorOr<gtirb::IR*> iOrE = gtirb::IR::load(ctx, std::cin))
       ir = *iOrE;
@@ -55,26 +33,28 @@ int main(int argc, char** argv) {
     fs::path irPath = irString;
     if (fs::exists(irPath)) {
       LOG_INFO << "Reading GTIRB file: " << irPath << std::endl;
-      std::ifstream in(irPath.string(), std::ios::in | std::ios::binary);
+      std::ifstream in;
+      in.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+      in.open(irPath.string(), std::ios::in | std::ios::binary);
       if (gtirb::ErrorOr<gtirb::IR*> iOrE = gtirb::IR::load(ctx, in))
         ir = *iOrE;
     } else {
       LOG_ERROR << "GTIRB file not found: " << irPath << std::endl;
-      return EXIT_FAILURE;
+      return false;
     }
   }
   if (!ir) {
     LOG_ERROR << "Failed to load the IR";
-    return EXIT_FAILURE;
+    return false;
   }
 
-  if (vm.count("remove") == 0) {
-    for (auto& M : ir->modules()) {
-      LOG_INFO << "Laying out module " << M.getUUID() << "..." << std::endl;
-      if (!gtirb_layout::layoutModule(ctx, M)) {
-        LOG_ERROR << "Laying out module failed!" << std::endl;
-        return EXIT_FAILURE;
-      }
+  if (!remove) {
+    LOG_INFO << "Laying out " << std::distance(ir->modules_begin(),
+                                               ir->modules_end())
+             << " modules..." << std::endl;
+    if (!gtirb_layout::layoutModules(ctx, *ir)) {
+      LOG_ERROR << "Laying out modules failed!" << std::endl;
+      return false;
     }
   } else {
     for (auto& M : ir->modules()) {
@@ -82,26 +62,82 @@ int main(int argc, char** argv) {
                << std::endl;
       if (!gtirb_layout::removeModuleLayout(ctx, M)) {
         LOG_ERROR << "Removing layout from module failed!" << std::endl;
-        return EXIT_FAILURE;
+        return false;
       }
     }
   }
 
-  auto outString = vm["out"].as<std::string>();
   if (outString == "-") {
     ir->save(std::cout);
-    return std::cout ? EXIT_SUCCESS : EXIT_FAILURE;
-  } else {
-    fs::path outPath = outString;
-    LOG_INFO << "Writing to GTIRB file: " << outPath << std::endl;
-    std::ofstream fileOut(outPath.string(), std::ios::out | std::ios::binary);
-    ir->save(fileOut);
-    if (!fileOut) {
-      LOG_ERROR << "Failed to write output!" << std::endl;
+    std::cout.flush();
+    return static_cast<bool>(std::cout);
+  }
+  fs::path outPath = outString;
+  LOG_INFO << "Writing to GTIRB file: " << outPath << std::endl;
+  std::ofstream fileOut;
+  fileOut.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  fileOut.open(outPath.string(), std::ios::out | std::ios::binary);
+  ir->save(fileOut);
+  fileOut.close();
+  if (!fileOut) {
+    LOG_ERROR << "Failed to write output!" << std::endl;
+    return false;
+  }
+  LOG_INFO << "Output written successfully. " << std::endl;
+  return true;
+}
+
+int main(int argc, char** argv) {
+  gtirb_layout::registerAuxDataTypes();
+
+  po::options_description desc("gtirb-layout - layout code and data in memory "
+                               "without overlap.\n\n"
+                               "Allowed options");
+  desc.add_options()("help,h", "Produce this help message.");
+  desc.add_options()(
+      "in,i", po::value<std::vector<std::string>>()->multitoken()->required(),
+      "Input GTIRB files.");
+  desc.add_options()(
+      "out,o", po::value<std::vector<std::string>>()->multitoken()->required(),
+      "Output GTIRB files, one for each input file.");
+  desc.add_options()("remove,r", "Remove layout instead of adding it.");
+
+  po::positional_options_description pd;
+  pd.add("in", 1);
+  pd.add("out", 1);
+
+  po::variables_map vm;
+  try {
+    po::store(
+        po::command_line_parser(argc, argv).options(desc).positional(pd).run(),
+        vm);
+    if (vm.count("help") != 0) {
+      std::cout << desc << std::endl;
+      return EXIT_FAILURE;
+    }
+    po::notify(vm);
+  } catch (std::exception& e) {
+    LOG_ERROR << e.what() << ". Try '" << argv[0]
+              << " --help' for more information." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto& inputs = vm["in"].as<std::vector<std::string>>();
+  const auto& outputs = vm["out"].as<std::vector<std::string>>();
+  if (inputs.size() != outputs.size()) {
+    LOG_ERROR << "Expected one output file for each of the " << inputs.size()
+              << " input files, got " << outputs.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Process every file in this process, so that setting up GTIRB is only paid
+  // for once. Each file gets its own context, so memory is released between
+  // files.
+  bool remove = vm.count("remove") != 0;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!processFile(inputs[i], outputs[i], remove)) {
       return EXIT_FAILURE;
-    } else {
-      LOG_INFO << "Output written successfully. " << std::endl;
-      return EXIT_SUCCESS;
     }
   }
+  return EXIT_SUCCESS;
 }
@@ -14,8 +14,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "gtirb_layout.hpp"
+#include "gtirb_pprinter/Parallel.hpp"
+#include <algorithm>
 #include <gtirb/gtirb.hpp>
-#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace gtirb;
 using namespace gtirb_layout;
@@ -23,6 +26,7 @@ using namespace gtirb_layout;
 void ::gtirb_layout::registerAuxDataTypes() {
   using namespace gtirb::schema;
   gtirb::AuxDataContainer::registerAuxDataType<Alignment>();
+  gtirb::AuxDataContainer::registerAuxDataType<gtirb::schema::LayoutHealth>();
 }
 
 /// Return the CFG containing the given block.
@@ -83,44 +87,105 @@ static ByteInterval* getPredecessorByteInterval(ByteInterval& TargetBI) {
   return nullptr;
 }
 
-bool ::gtirb_layout::layoutRequired(
-    Module& M, std::unordered_set<std::string> SkipSections) {
+/// Scan the sections of a module for problems that require a new layout.
+///
+/// \param M             Module to scan.
+/// \param SkipSections  names of sections to ignore.
+/// \param FirstOnly     stop at the first problem found.
+/// \param Health        summary to update.
+static void scanSections(const Module& M,
+                         const std::unordered_set<std::string>& SkipSections,
+                         bool FirstOnly, LayoutHealth& Health) {
   // If the module has no sections, we don't care that it has no address.
-  if (!M.sections().empty()) {
-    for (auto SecIt = M.sections_begin(); SecIt != M.sections_end(); ++SecIt) {
-      if (SkipSections.count(SecIt->getName())) {
-        continue;
-      }
-      if (!SecIt->getAddress()) {
-        // The pretty-printer requires that every section must have an address.
-        return true;
+  for (auto SecIt = M.sections_begin(); SecIt != M.sections_end(); ++SecIt) {
+    if (SkipSections.count(SecIt->getName())) {
+      continue;
+    }
+    auto Range = addressRange(*SecIt);
+    if (!Range) {
+      // The pretty-printer requires that every section must have an address.
+      ++Health.UnaddressedSections;
+      Health.LayoutRequired = true;
+      if (FirstOnly) {
+        return;
       }
-      if (auto Next = std::next(SecIt); Next != M.sections_end()) {
-        // There is a section following this one. Because the module has an
-        // address, we know all of the sections have addresses.
-        if (addressRange(*Next)->lower() < addressRange(*SecIt)->upper()) {
-          // Sections overlap.
-          return true;
+      continue;
+    }
+    if (auto Next = std::next(SecIt); Next != M.sections_end()) {
+      // There is a section following this one. Sections are sorted by
+      // address, so it has an address too.
+      auto NextRange = addressRange(*Next);
+      if (NextRange && NextRange->lower() < Range->upper()) {
+        // Sections overlap.
+        ++Health.Overlaps;
+        Health.LayoutRequired = true;
+        if (FirstOnly) {
+          return;
         }
       }
+    }
 
-      // Because the section has an address, we know it has at least one byte
-      // interval and each of its byte intervals has an address.
-      for (auto BiIt = SecIt->byte_intervals_begin(), Next = std::next(BiIt);
-           Next != SecIt->byte_intervals_end(); ++BiIt, ++Next) {
-        if (addressRange(*Next)->lower() < addressRange(*BiIt)->upper()) {
-          // Byte intervals overlap.
-          return true;
+    // Because the section has an address, we know it has at least one byte
+    // interval and each of its byte intervals has an address.
+    for (auto BiIt = SecIt->byte_intervals_begin(), Next = std::next(BiIt);
+         Next != SecIt->byte_intervals_end(); ++BiIt, ++Next) {
+      if (addressRange(*Next)->lower() < addressRange(*BiIt)->upper()) {
+        // Byte intervals overlap.
+        ++Health.Overlaps;
+        Health.LayoutRequired = true;
+        if (FirstOnly) {
+          return;
         }
       }
-      // FIXME: Should we also check that blocks are aligned according to the
-      // "alignment" AuxData?
-      // FIXME: Should we also check that CodeBlocks with a fallthrough edge
-      // are in different ByteIntervals or are adjacent in the same
-      // ByteInterval?
     }
+    // FIXME: Should we also check that blocks are aligned according to the
+    // "alignment" AuxData?
+    // FIXME: Should we also check that CodeBlocks with a fallthrough edge
+    // are in different ByteIntervals or are adjacent in the same
+    // ByteInterval?
   }
-  return false;
+}
+
+bool ::gtirb_layout::layoutRequired(
+    Module& M, const std::unordered_set<std::string>& SkipSections) {
+  LayoutHealth Health;
+  scanSections(M, SkipSections, true, Health);
+  return Health.LayoutRequired;
+}
+
+LayoutHealth gtirb_layout::checkLayout(
+    const Module& M, const std::unordered_set<std::string>& SkipSections) {
+  LayoutHealth Health;
+  scanSections(M, SkipSections, false, Health);
+  for (const Symbol& Sym : M.symbols()) {
+    if (!Sym.hasReferent() && Sym.getAddress()) {
+      ++Health.IntegralSymbols;
+    }
+  }
+  return Health;
+}
+
+LayoutHealth gtirb_layout::cacheLayoutHealth(
+    Module& M, const std::unordered_set<std::string>& SkipSections) {
+  LayoutHealth Health = checkLayout(M, SkipSections);
+  M.addAuxData<gtirb::schema::LayoutHealth>(
+      {Health.LayoutRequired, Health.UnaddressedSections, Health.Overlaps,
+       Health.IntegralSymbols});
+  return Health;
+}
+
+std::optional<LayoutHealth>
+gtirb_layout::getCachedLayoutHealth(const Module& M) {
+  const auto* Cached = M.getAuxData<gtirb::schema::LayoutHealth>();
+  if (!Cached) {
+    return std::nullopt;
+  }
+  LayoutHealth Health;
+  Health.LayoutRequired = std::get<0>(*Cached);
+  Health.UnaddressedSections = std::get<1>(*Cached);
+  Health.Overlaps = std::get<2>(*Cached);
+  Health.IntegralSymbols = std::get<3>(*Cached);
+  return Health;
 }
 
 bool ::gtirb_layout::layoutRequired(IR& Ir) {
@@ -139,6 +204,120 @@ bool ::gtirb_layout::layoutRequired(IR& Ir) {
 #pragma warning(disable : 4702) // unreachable code
 #endif
 
+/// An integral symbol to be given a referent in a ByteInterval.
+struct IntegralSymbol {
+  Symbol* Sym;
+  /// Offset of the symbol's address in the ByteInterval.
+  uint64_t Offset;
+  /// The symbol refers to the end of the ByteInterval.
+  bool AtEnd;
+};
+
+/// Point a symbol at a code or data block.
+static void setBlockReferent(Symbol& Sym, Node* Block) {
+  if (auto* CB = dyn_cast<CodeBlock>(Block)) {
+    Sym.setReferent(CB);
+  } else if (auto* DB = dyn_cast<DataBlock>(Block)) {
+    Sym.setReferent(DB);
+  } else {
+    assert(!"found non-block in block iterator!");
+  }
+}
+
+/// Give referents to integral symbols that fall in a ByteInterval.
+///
+/// Symbols at the address of a block refer to the first such block. Other
+/// symbols refer to new 0-length blocks, of the same type as the first block
+/// that encompasses their address if there is one and data blocks otherwise.
+/// Symbols at the same address share a block.
+///
+/// \param Ctx      Context to create new blocks in.
+/// \param BI       ByteInterval containing the symbols.
+/// \param Symbols  symbols to fix, sorted by offset.
+static void fixIntervalSymbols(Context& Ctx, ByteInterval& BI,
+                               const std::vector<IntegralSymbol>& Symbols) {
+  struct BlockExtent {
+    uint64_t Offset;
+    uint64_t End;
+    Node* Block;
+  };
+  std::vector<BlockExtent> Blocks;
+  for (auto& Block : BI.blocks()) {
+    if (auto* CB = dyn_cast<CodeBlock>(&Block)) {
+      Blocks.push_back({CB->getOffset(), CB->getOffset() + CB->getSize(), CB});
+    } else if (auto* DB = dyn_cast<DataBlock>(&Block)) {
+      Blocks.push_back({DB->getOffset(), DB->getOffset() + DB->getSize(), DB});
+    }
+  }
+
+  struct NewBlock {
+    uint64_t Offset;
+    bool Code;
+    std::vector<Symbol*> Symbols;
+  };
+  std::vector<NewBlock> NewBlocks;
+
+  // Sweep the symbols and blocks together. Active holds the blocks that start
+  // before the current offset and may still encompass it.
+  std::vector<const BlockExtent*> Active;
+  size_t Next = 0;
+  std::optional<uint64_t> LastOffset;
+  Node* LastBlock = nullptr;
+  for (const IntegralSymbol& IS : Symbols) {
+    if (IS.Offset == LastOffset) {
+      // Share the block of the previous symbol at this address.
+      if (LastBlock) {
+        setBlockReferent(*IS.Sym, LastBlock);
+      } else {
+        NewBlocks.back().Symbols.push_back(IS.Sym);
+      }
+      continue;
+    }
+    LastOffset = IS.Offset;
+    LastBlock = nullptr;
+
+    // A symbol at the end of the interval always gets a new data block.
+    if (IS.AtEnd) {
+      NewBlocks.push_back({IS.Offset, false, {IS.Sym}});
+      continue;
+    }
+
+    while (Next < Blocks.size() && Blocks[Next].Offset < IS.Offset) {
+      Active.push_back(&Blocks[Next++]);
+    }
+    Active.erase(std::remove_if(Active.begin(), Active.end(),
+                                [&](const BlockExtent* B) {
+                                  return B->End <= IS.Offset;
+                                }),
+                 Active.end());
+
+    // Do we have a block at this exact address?
+    if (Next < Blocks.size() && Blocks[Next].Offset == IS.Offset) {
+      LastBlock = Blocks[Next].Block;
+      setBlockReferent(*IS.Sym, LastBlock);
+      continue;
+    }
+
+    // If a block encompasses this address, make a new 0-length block of the
+    // same type. If all else fails, make it a new 0-length data block.
+    bool Code = !Active.empty() && isa<CodeBlock>(Active.front()->Block);
+    NewBlocks.push_back({IS.Offset, Code, {IS.Sym}});
+  }
+
+  // Add the new blocks once the sweep is done.
+  for (const NewBlock& NB : NewBlocks) {
+    Node* Block = nullptr;
+    if (NB.Code) {
+      Block = BI.addBlock<CodeBlock>(Ctx, NB.Offset, 0);
+    } else {
+      Block = BI.addBlock<DataBlock>(Ctx, NB.Offset, 0);
+    }
+    for (Symbol* Sym : NB.Symbols) {
+      setBlockReferent(*Sym, Block);
+    }
+  }
+}
+
 void ::gtirb_layout::fixIntegralSymbols(gtirb::Context& Ctx, gtirb::Module& M) {
   // In general, we want as many integral symbols to not be integral as
   // possible. If they point to blocks, even 0-length ones, instead of raw
@@ -146,83 +325,83 @@ void ::gtirb_layout::fixIntegralSymbols(gtirb::Context& Ctx, gtirb::Module& M) {
   // addresses later in the layout process. This also removes the need
   // for the pretty-printer to check if it needs to print a symbol every time
   // the program counter increments.
-  std::vector<Symbol*> IntSyms;
+  //
+  // Every function that changes the layout starts here, so this is where the
+  // cached layout summary goes stale.
+  M.removeAuxData<gtirb::schema::LayoutHealth>();
+
+  std::vector<std::pair<uint64_t, Symbol*>> IntSyms;
   for (auto& Sym : M.symbols()) {
     if (!Sym.hasReferent() && Sym.getAddress()) {
-      IntSyms.push_back(&Sym);
+      IntSyms.emplace_back(static_cast<uint64_t>(*Sym.getAddress()), &Sym);
     }
   }
-
-  for (auto* Sym : IntSyms) {
-    auto Addr = *Sym->getAddress();
-    bool FoundReferent = false;
-
-    // If a byte interval encompasses this address, then we can redirect
-    // the symbol to point to it.
-    for (auto& BI : M.findByteIntervalsOn(Addr)) {
-      FoundReferent = true;
-
-      // do we have a block at this exact address?
-      Node* ExactMatch = nullptr;
-      for (auto& Block : BI.findBlocksAt(Addr)) {
-        ExactMatch = &Block;
-        break;
-      }
-      if (ExactMatch) {
-        // If so, set the referent to it.
-        if (isa<CodeBlock>(ExactMatch)) {
-          Sym->setReferent(cast<CodeBlock>(ExactMatch));
-        } else if (isa<DataBlock>(ExactMatch)) {
-          Sym->setReferent(cast<DataBlock>(ExactMatch));
-        } else {
-          assert(!"found non-block in block iterator!");
-        }
-        break;
-      }
-
-      // Do we have a block encompassing this exact address?
-      Node* ApproxMatch = nullptr;
-      for (auto& Block : BI.findBlocksOn(Addr)) {
-        ApproxMatch = &Block;
-        break;
-      }
-      if (ApproxMatch) {
-        // If so, make a new 0-length block of the same type.
-        if (isa<CodeBlock>(ApproxMatch)) {
-          CodeBlock* NewRef =
-              BI.addBlock<CodeBlock>(Ctx, Addr - *BI.getAddress(), 0);
-          Sym->setReferent(NewRef);
-        } else if (isa<DataBlock>(ApproxMatch)) {
-          DataBlock* NewRef =
-              BI.addBlock<DataBlock>(Ctx, Addr - *BI.getAddress(), 0);
-          Sym->setReferent(NewRef);
-        } else {
-          assert(!"found non-block in block iterator!");
-        }
-        break;
-      }
-
-      // if all else fails, make it a new 0-length data block.
-      DataBlock* NewRef =
-          BI.addBlock<DataBlock>(Ctx, Addr - *BI.getAddress(), 0);
-      Sym->setReferent(NewRef);
-      break;
+  if (IntSyms.empty()) {
+    return;
+  }
+  std::stable_sort(
+      IntSyms.begin(), IntSyms.end(),
+      [](const auto& L, const auto& R) { return L.first < R.first; });
+
+  struct IntervalExtent {
+    uint64_t Start;
+    uint64_t End;
+    ByteInterval* BI;
+  };
+  std::vector<IntervalExtent> Intervals;
+  for (ByteInterval& BI : M.byte_intervals()) {
+    if (auto A = BI.getAddress()) {
+      uint64_t Start = static_cast<uint64_t>(*A);
+      Intervals.push_back({Start, Start + BI.getSize(), &BI});
     }
-
-    if (FoundReferent)
+  }
+  std::stable_sort(Intervals.begin(), Intervals.end(),
+                   [](const IntervalExtent& L, const IntervalExtent& R) {
+                     return L.Start < R.Start;
+                   });
+
+  // Sweep the symbols and intervals together, assigning each symbol to the
+  // first interval that encompasses its address or, failing that, to the
+  // first interval that ends at its address. Active holds the intervals that
+  // start at or before the current address and do not end before it.
+  std::vector<std::vector<IntegralSymbol>> Matches(Intervals.size());
+  std::vector<size_t> Active;
+  size_t Next = 0;
+  for (const auto& IntSym : IntSyms) {
+    uint64_t Address = IntSym.first;
+    Symbol* Sym = IntSym.second;
+    while (Next < Intervals.size() && Intervals[Next].Start <= Address) {
+      Active.push_back(Next++);
+    }
+    Active.erase(std::remove_if(Active.begin(), Active.end(),
+                                [&](size_t I) {
+                                  return Intervals[I].End < Address;
+                                }),
+                 Active.end());
+
+    auto On = std::find_if(Active.begin(), Active.end(), [&](size_t I) {
+      return Address < Intervals[I].End;
+    });
+    if (On != Active.end()) {
+      Matches[*On].push_back({Sym, Address - Intervals[*On].Start, false});
       continue;
+    }
     // This symbol may refer to the end of a byte interval.
-    // If so, make a new 0-length data block pointing at the end of the BI.
-    for (auto& BI : M.findByteIntervalsOn(Addr - 1)) {
-      FoundReferent = true;
-      DataBlock* NewRef =
-          BI.addBlock<DataBlock>(Ctx, Addr - *BI.getAddress(), 0);
-      Sym->setReferent(NewRef);
-      break;
+    auto AtEnd = std::find_if(Active.begin(), Active.end(), [&](size_t I) {
+      return Intervals[I].Start < Address && Intervals[I].End == Address;
+    });
+    if (AtEnd != Active.end()) {
+      Matches[*AtEnd].push_back(
+          {Sym, Address - Intervals[*AtEnd].Start, true});
     }
+    // TODO: otherwise, emit a warning that an integral symbol was not
+    // relocated.
+  }
 
-    // TODO: if !FoundReferent, then emit a warning that an integral symbol
-    // was not relocated.
+  for (size_t I = 0; I < Intervals.size(); ++I) {
+    if (!Matches[I].empty()) {
+      fixIntervalSymbols(Ctx, *Intervals[I].BI, Matches[I]);
+    }
   }
 }
 
@@ -253,59 +432,98 @@ static std::optional<uint64_t> defaultAlignment(std::optional<Addr> A) {
   return std::nullopt;
 }
 
-/// Collect the required alignments for blocks in a module.
-///
-/// Uses the module's "alignment" AuxData, if present. For any ByteIntervals
-/// with addresses that do not contain blocks with user-defined alignment, the
-/// blocks in that ByteInterval will be assumed to be aligned to the largest
-/// power of two that is consistent with their current alignment.
+/// User-specified alignments for the blocks of a module, taken from its
+/// "alignment" AuxData.
+struct UserAlignments {
+  std::unordered_map<const Node*, uint64_t> Blocks;
+  /// ByteIntervals containing at least one block in \c Blocks.
+  std::unordered_set<const ByteInterval*> Intervals;
+};
+
+/// Resolve the module's "alignment" AuxData to the blocks it refers to.
 ///
 /// \param Ctx  used to look up the UUIDs in the "alignment" AuxData.
 /// \param M    module to gather alignments for.
 ///
-/// \return An alignment table for blocks in the module.
-static gtirb::schema::Alignment::Type getAlignments(const Context& Ctx,
-                                                    const Module& M) {
+/// \return the user-specified alignments for blocks in the module.
+static UserAlignments getUserAlignments(const Context& Ctx, const Module& M) {
   using namespace gtirb::schema;
 
-  Alignment::Type Alignments;
-
-  // Start with the user-specified alignment, if possible.
-
-  std::set<UUID> UserAligned;
+  UserAlignments Result;
   if (const auto* AuxData = M.getAuxData<Alignment>()) {
-    for (const auto& Pair : *AuxData) {
-      if (const auto* N = Node::getByUUID(Ctx, std::get<const UUID>(Pair))) {
+    for (const auto& [Uuid, Align] : *AuxData) {
+      if (const auto* N = Node::getByUUID(Ctx, Uuid)) {
         if (const auto* CB = dyn_cast<CodeBlock>(N)) {
-          UserAligned.insert(CB->getByteInterval()->getUUID());
+          Result.Blocks.emplace(N, Align);
+          Result.Intervals.insert(CB->getByteInterval());
         } else if (const auto* DB = dyn_cast<DataBlock>(N)) {
-          UserAligned.insert(DB->getByteInterval()->getUUID());
+          Result.Blocks.emplace(N, Align);
+          Result.Intervals.insert(DB->getByteInterval());
         }
         // Aligning other node types (e.g., Section) is not currently supported.
       }
     }
-    Alignments.insert(AuxData->begin(), AuxData->end());
   }
+  return Result;
+}
 
-  // Compute default alignment for blocks in byte intervals that were not
-  // aligned by the user.
+/// A ByteInterval to be placed, with the alignment constraint it must keep.
+struct IntervalLayout {
+  ByteInterval* BI;
+  uint64_t Size;
+  /// Offset of the first aligned block in the interval.
+  uint64_t AlignedOffset = 0;
+  /// Alignment of that block, if the interval has an aligned block.
+  std::optional<uint64_t> Alignment;
+};
+
+/// Find the alignment constraint of a ByteInterval: the alignment of its first
+/// block with a required alignment.
+///
+/// Uses the user-specified alignments if any block in the interval has one.
+/// Otherwise, if the interval has an address, each block is assumed to be
+/// aligned to the largest power of two that is consistent with its current
+/// address.
+///
+/// \param BI    ByteInterval to find the constraint for.
+/// \param User  user-specified alignments for the module.
+///
+/// \return the interval with its alignment constraint.
+static IntervalLayout getIntervalLayout(ByteInterval& BI,
+                                        const UserAlignments& User) {
+  IntervalLayout Layout{&BI, BI.getSize()};
+  bool UserAligned = User.Intervals.count(&BI) != 0;
+  if (!UserAligned && !BI.getAddress()) {
+    return Layout;
+  }
+  for (auto& Block : BI.blocks()) {
+    uint64_t Offset = 0;
+    std::optional<Addr> BlockAddr;
+    if (auto* CB = dyn_cast<CodeBlock>(&Block)) {
+      Offset = CB->getOffset();
+      BlockAddr = CB->getAddress();
+    } else if (auto* DB = dyn_cast<DataBlock>(&Block)) {
+      Offset = DB->getOffset();
+      BlockAddr = DB->getAddress();
+    } else {
+      assert(!"Unexpected block type: neither CodeBlock nor DataBlock");
+    }
 
-  for (const ByteInterval& BI : M.byte_intervals()) {
-    if (BI.getAddress() && !UserAligned.count(BI.getUUID())) {
-      for (const CodeBlock& Block : BI.code_blocks()) {
-        if (auto Align = defaultAlignment(Block.getAddress())) {
-          Alignments.emplace(Block.getUUID(), *Align);
-        }
-      }
-      for (const DataBlock& Block : BI.data_blocks()) {
-        if (auto Align = defaultAlignment(Block.getAddress())) {
-          Alignments.emplace(Block.getUUID(), *Align);
-        }
+    std::optional<uint64_t> Align;
+    if (UserAligned) {
+      if (auto It = User.Blocks.find(&Block); It != User.Blocks.end()) {
+        Align = It->second;
       }
+    } else {
+      Align = defaultAlignment(BlockAddr);
+    }
+    if (Align) {
+      Layout.AlignedOffset = Offset;
+      Layout.Alignment = Align;
+      break;
     }
   }
-
-  return Alignments;
+  return Layout;
 }
 
 /// Sort the ByteIntervals in a Section so that the sources of fallthrough edges
@@ -321,12 +539,12 @@ static gtirb::schema::Alignment::Type getAlignments(const Context& Ctx,
 /// \return a vector containing the sorted pointers to the byte intervals.
 static std::vector<ByteInterval*> toposort(Section& S) {
   std::vector<ByteInterval*> Sorted;
-  std::set<ByteInterval*> Visited;
+  std::unordered_set<const ByteInterval*> Visited;
+  std::vector<ByteInterval*> Pending;
   for (ByteInterval& BI : S.byte_intervals()) {
-    std::vector<ByteInterval*> Pending;
+    Pending.clear();
     ByteInterval* Pred = &BI;
-    while (Pred && !Visited.count(Pred)) {
-      Visited.insert(Pred);
+    while (Pred && Visited.insert(Pred).second) {
       Pending.push_back(Pred);
       Pred = getPredecessorByteInterval(*Pred);
     }
@@ -335,47 +553,162 @@ static std::vector<ByteInterval*> toposort(Section& S) {
   return Sorted;
 }
 
-bool ::gtirb_layout::layoutModule(gtirb::Context& Ctx, Module& M) {
-  using namespace gtirb::schema;
+/// Assign addresses to the byte intervals of the given sections, placing the
+/// sections one after another.
+///
+/// \param Sections  sections to place, in order.
+/// \param User      user-specified alignments for the module.
+/// \param Start     address to place the first section at.
+///
+/// \param Parallel  process the sections on a pool of worker threads.
+///
+/// \return the number of byte intervals whose address changed.
+static size_t placeSections(const std::vector<Section*>& Sections,
+                            const UserAlignments& User, uint64_t Start,
+                            bool Parallel = true) {
+  // Order the intervals of each section and find their alignment constraints.
+  // This only reads the module, so the sections can be processed in parallel.
+  std::vector<std::vector<IntervalLayout>> Layouts(Sections.size());
+  auto layoutSection = [&](size_t I) {
+    std::vector<ByteInterval*> Sorted = toposort(*Sections[I]);
+    Layouts[I].reserve(Sorted.size());
+    for (ByteInterval* BI : Sorted) {
+      Layouts[I].push_back(getIntervalLayout(*BI, User));
+    }
+  };
+  if (Parallel) {
+    gtirb_pprint::parallelFor(Sections.size(), layoutSection);
+  } else {
+    for (size_t I = 0; I < Sections.size(); ++I) {
+      layoutSection(I);
+    }
+  }
+
+  // Place the intervals one after another. The padding needed to keep an
+  // alignment depends on the address reached so far, so this is a running sum
+  // over the flattened intervals.
+  size_t Moved = 0;
+  uint64_t A = Start;
+  for (const auto& SectionLayout : Layouts) {
+    for (const IntervalLayout& Layout : SectionLayout) {
+      // If this interval contains any blocks with requested alignment, update
+      // the address to maintain the alignment of the first of them.
+      if (Layout.Alignment) {
+        uint64_t Mask = *Layout.Alignment - 1;
+        uint64_t OffsetAddr = A + Layout.AlignedOffset;
+        if (OffsetAddr & Mask) {
+          A += Mask - (OffsetAddr & Mask) + 1;
+        }
+      }
+      if (Layout.BI->getAddress() != Addr(A)) {
+        Layout.BI->setAddress(Addr(A));
+        ++Moved;
+      }
+      A += Layout.Size;
+    }
+  }
+  return Moved;
+}
+
+/// Determine whether the byte intervals of an addressed section overlap.
+static bool hasOverlappingIntervals(Section& S) {
+  for (auto BiIt = S.byte_intervals_begin(), Next = std::next(BiIt);
+       Next != S.byte_intervals_end(); ++BiIt, ++Next) {
+    if (addressRange(*Next)->lower() < addressRange(*BiIt)->upper()) {
+      return true;
+    }
+  }
+  return false;
+}
 
+/// Lay out every section of a module from address 0. Does not modify the
+/// context, so different modules can be placed concurrently.
+static void placeModule(const Context& Ctx, Module& M, bool Parallel) {
+  UserAlignments User = getUserAlignments(Ctx, M);
+
+  // Store a list of sections first, because setting the address of a BI
+  // invalidates parent iterators.
+  std::vector<Section*> Sections;
+  for (Section& S : M.sections()) {
+    Sections.push_back(&S);
+  }
+  placeSections(Sections, User, 0, Parallel);
+}
+
+bool ::gtirb_layout::layoutModule(gtirb::Context& Ctx, Module& M) {
   // Fix symbols with integral referents that point to known objects.
   fixIntegralSymbols(Ctx, M);
 
-  // Get the desired ByteInterval alignments.
+  placeModule(Ctx, M, true);
 
-  Alignment::Type Alignments = getAlignments(Ctx, M);
+  return true;
+}
 
-  // Store a list of sections and then iterate over them, because
-  // setting the address of a BI invalidates parent iterators.
-  uint64_t A = 0;
-  std::vector<std::reference_wrapper<Section>> Sections(M.sections_begin(),
-                                                        M.sections_end());
-  for (auto& S : Sections) {
-    for (ByteInterval* BI : toposort(S)) {
-      // If this interval contains any blocks with requested alignment, update
-      // the address to maintain the alignment of the first of them.
-      for (auto& Block : BI->blocks()) {
-        if (auto It = Alignments.find(Block.getUUID());
-            It != Alignments.end()) {
-          uint64_t Mask = It->second - 1;
-          uint64_t OffsetAddr = 0;
-          if (auto* CB = dyn_cast<CodeBlock>(&Block)) {
-            OffsetAddr = A + CB->getOffset();
-          } else if (auto* DB = dyn_cast<DataBlock>(&Block)) {
-            OffsetAddr = A + DB->getOffset();
-          } else {
-            assert(!"Unexpected block type: neither CodeBlock nor DataBlock");
-          }
-          if (OffsetAddr & Mask) {
-            A += Mask - (OffsetAddr & Mask) + 1;
-          }
-          break;
-        }
+bool ::gtirb_layout::layoutModules(gtirb::Context& Ctx, IR& Ir) {
+  std::vector<Module*> Modules;
+  for (Module& M : Ir.modules()) {
+    Modules.push_back(&M);
+  }
+  if (Modules.size() == 1) {
+    return layoutModule(Ctx, *Modules.front());
+  }
+
+  // Fixing integral symbols may allocate new blocks in the context, which is
+  // shared by every module, so it is done for all modules first. Placing a
+  // module then only reads the context and writes to the module itself.
+  for (Module* M : Modules) {
+    fixIntegralSymbols(Ctx, *M);
+  }
+  gtirb_pprint::parallelFor(Modules.size(), [&](size_t I) {
+    placeModule(Ctx, *Modules[I], false);
+  });
+
+  return true;
+}
+
+bool ::gtirb_layout::layoutModuleIncremental(gtirb::Context& Ctx, Module& M,
+                                             size_t* MovedIntervals) {
+  // Fix symbols with integral referents that point to known objects.
+  fixIntegralSymbols(Ctx, M);
+
+  // Keep sections, in address order, up to the first one that overlaps the
+  // sections kept so far or has overlapping intervals of its own.
+  std::vector<Section*> Sections;
+  std::unordered_set<const Section*> Kept;
+  uint64_t End = 0;
+  bool Keeping = true;
+  for (Section& S : M.sections()) {
+    Sections.push_back(&S);
+    if (!Keeping) {
+      continue;
+    }
+    // Sections without an address are placed after the kept sections, but do
+    // not end the kept run.
+    if (auto Range = addressRange(S)) {
+      if (static_cast<uint64_t>(Range->lower()) < End ||
+          hasOverlappingIntervals(S)) {
+        Keeping = false;
+        continue;
       }
-      BI->setAddress(Addr(A));
-      A += BI->getSize();
+      Kept.insert(&S);
+      End = static_cast<uint64_t>(Range->upper());
+    }
+  }
+
+  // Lay out the remaining sections after the kept ones.
+  std::vector<Section*> Moving;
+  for (Section* S : Sections) {
+    if (!Kept.count(S)) {
+      Moving.push_back(S);
     }
   }
+  size_t Moved = 0;
+  if (!Moving.empty()) {
+    Moved = placeSections(Moving, getUserAlignments(Ctx, M), End);
+  }
+  if (MovedIntervals) {
+    *MovedIntervals = Moved;
+  }
 
   return true;
 }
@@ -1,5 +1,6 @@
 #include "gtirb_layout/gtirb_layout.hpp"
 
+#include <algorithm>
 #include <gtest/gtest.h>
 
 using namespace gtirb;
@@ -37,6 +38,64 @@ TEST(Unit_Layout, layoutRequired) {
   EXPECT_TRUE(layoutRequired(*Ir));
 }
 
+TEST(Unit_Layout, checkLayout) {
+  Context C;
+  Module* M = Module::Create(C, "test");
+
+  LayoutHealth Health = checkLayout(*M);
+  EXPECT_FALSE(Health.LayoutRequired);
+  EXPECT_EQ(0, Health.Overlaps);
+
+  Section* S1 = M->addSection(C, ".test1");
+  S1->addByteInterval(C, Addr(0x100), 0x10);
+  S1->addByteInterval(C, Addr(0x108), 0x10);
+  Section* S2 = M->addSection(C, ".test2");
+  S2->addByteInterval(C, Addr(0x110), 0x10);
+  Section* S3 = M->addSection(C, ".test3");
+  S3->addByteInterval(C, 0x10);
+  M->addSymbol(C, Addr(0x104), "integral");
+
+  // Unlike layoutRequired, every problem is counted.
+  Health = checkLayout(*M);
+  EXPECT_TRUE(Health.LayoutRequired);
+  EXPECT_EQ(1, Health.UnaddressedSections);
+  EXPECT_EQ(2, Health.Overlaps);
+  EXPECT_EQ(1, Health.IntegralSymbols);
+
+  // Skipped sections are ignored.
+  Health = checkLayout(*M, {".test1", ".test3"});
+  EXPECT_FALSE(Health.LayoutRequired);
+  EXPECT_EQ(0, Health.UnaddressedSections);
+  EXPECT_EQ(0, Health.Overlaps);
+  EXPECT_EQ(1, Health.IntegralSymbols);
+}
+
+TEST(Unit_Layout, cacheLayoutHealth) {
+  Context C;
+  Module* M = Module::Create(C, "test");
+  EXPECT_FALSE(getCachedLayoutHealth(*M));
+
+  Section* S = M->addSection(C, ".test");
+  S->addByteInterval(C, Addr(0x100), 0x10);
+  S->addByteInterval(C, Addr(0x108), 0x10);
+  M->addSymbol(C, Addr(0x104), "integral");
+
+  LayoutHealth Health = cacheLayoutHealth(*M);
+  EXPECT_TRUE(Health.LayoutRequired);
+  EXPECT_EQ(1, Health.Overlaps);
+
+  auto Cached = getCachedLayoutHealth(*M);
+  ASSERT_TRUE(Cached);
+  EXPECT_TRUE(Cached->LayoutRequired);
+  EXPECT_EQ(0, Cached->UnaddressedSections);
+  EXPECT_EQ(1, Cached->Overlaps);
+  EXPECT_EQ(1, Cached->IntegralSymbols);
+
+  // Changing the layout drops the cached summary.
+  layoutModule(C, *M);
+  EXPECT_FALSE(getCachedLayoutHealth(*M));
+}
+
 TEST(Unit_Layout, fixIntegralSymbols) {
   Context C;
   Module* M = Module::Create(C, "test");
@@ -69,6 +128,39 @@ TEST(Unit_Layout, fixIntegralSymbols) {
   EXPECT_TRUE(S110->getReferent<DataBlock>());
 }
 
+TEST(Unit_Layout, fixIntegralSymbolsManyIntervals) {
+  Context C;
+  Module* M = Module::Create(C, "test");
+  Section* S = M->addSection(C, ".test");
+  ByteInterval* BI1 = S->addByteInterval(C, Addr(0x200), 8);
+  ByteInterval* BI2 = S->addByteInterval(C, Addr(0x100), 8);
+  CodeBlock* CB = BI2->addBlock<CodeBlock>(C, 0, 8);
+
+  // Add the symbols out of address order.
+  Symbol* S204 = M->addSymbol(C, Addr(0x204), "s204");
+  Symbol* S104A = M->addSymbol(C, Addr(0x104), "s104a");
+  Symbol* S208 = M->addSymbol(C, Addr(0x208), "s208");
+  Symbol* S104B = M->addSymbol(C, Addr(0x104), "s104b");
+  Symbol* S100 = M->addSymbol(C, Addr(0x100), "s100");
+  Symbol* S300 = M->addSymbol(C, Addr(0x300), "s300");
+
+  fixIntegralSymbols(C, *M);
+
+  EXPECT_EQ(CB, S100->getReferent<CodeBlock>());
+  ASSERT_TRUE(S104A->getReferent<CodeBlock>());
+  EXPECT_EQ(BI2, S104A->getReferent<CodeBlock>()->getByteInterval());
+  // Symbols at the same address share a block.
+  EXPECT_EQ(S104A->getReferent<CodeBlock>(), S104B->getReferent<CodeBlock>());
+  ASSERT_TRUE(S204->getReferent<DataBlock>());
+  EXPECT_EQ(BI1, S204->getReferent<DataBlock>()->getByteInterval());
+  ASSERT_TRUE(S208->getReferent<DataBlock>());
+  EXPECT_EQ(BI1, S208->getReferent<DataBlock>()->getByteInterval());
+  EXPECT_EQ(Addr(0x208), S208->getAddress());
+  // Symbols outside every interval stay integral.
+  EXPECT_FALSE(S300->hasReferent());
+  EXPECT_EQ(Addr(0x300), S300->getAddress());
+}
+
 TEST(Unit_Layout, removeModuleLayout) {
   Context C;
   IR* Ir = IR::Create(C);
@@ -175,6 +267,131 @@ TEST(Unit_Layout, layoutModuleWithCFG) {
   EXPECT_FALSE(layoutRequired(*Ir));
 }
 
+TEST(Unit_Layout, layoutModuleManySections) {
+  using namespace gtirb::schema;
+
+  Context C;
+  Module* M = Module::Create(C, "test");
+  std::vector<ByteInterval*> Intervals;
+  std::vector<DataBlock*> Aligned;
+  for (int I = 0; I < 64; ++I) {
+    Section* S = M->addSection(C, ".test" + std::to_string(I));
+    ByteInterval* BI1 = S->addByteInterval(C, 3 + I);
+    ByteInterval* BI2 = S->addByteInterval(C, 5);
+    BI1->addBlock<DataBlock>(C, 0, 3 + I);
+    Aligned.push_back(BI2->addBlock<DataBlock>(C, 1, 4));
+    Intervals.push_back(BI1);
+    Intervals.push_back(BI2);
+  }
+  Alignment::Type Alignments;
+  for (DataBlock* DB : Aligned) {
+    Alignments.emplace(DB->getUUID(), 8);
+  }
+  M->addAuxData<Alignment>(std::move(Alignments));
+
+  layoutModule(C, *M);
+
+  // No two intervals overlap.
+  for (ByteInterval* BI : Intervals) {
+    ASSERT_TRUE(BI->getAddress());
+  }
+  std::sort(Intervals.begin(), Intervals.end(),
+            [](ByteInterval* L, ByteInterval* R) {
+              return *L->getAddress() < *R->getAddress();
+            });
+  for (size_t I = 1; I < Intervals.size(); ++I) {
+    EXPECT_LE(*Intervals[I - 1]->getAddress() + Intervals[I - 1]->getSize(),
+              *Intervals[I]->getAddress());
+  }
+  for (DataBlock* DB : Aligned) {
+    EXPECT_EQ(0, static_cast<uint64_t>(*DB->getAddress()) & 0x7);
+  }
+  EXPECT_FALSE(layoutRequired(*M));
+}
+
+TEST(Unit_Layout, layoutModulesSharedContext) {
+  Context C;
+  IR* Ir = IR::Create(C);
+  std::vector<Module*> Modules;
+  std::vector<Symbol*> Integral;
+  for (int I = 0; I < 4; ++I) {
+    Module* M = Ir->addModule(C, "test" + std::to_string(I));
+    Modules.push_back(M);
+    for (int J = 0; J < 8; ++J) {
+      // Each section overlaps the next one.
+      Section* S = M->addSection(C, ".test" + std::to_string(J));
+      ByteInterval* BI = S->addByteInterval(C, Addr(0x100 + 0xc * J), 0x10);
+      BI->addBlock<DataBlock>(C, 0, 4);
+      // Without a block at its address, fixing the symbol allocates one.
+      Integral.push_back(M->addSymbol(C, Addr(0x106 + 0xc * J),
+                                      "s" + std::to_string(J)));
+    }
+  }
+
+  layoutModules(C, *Ir);
+
+  for (Module* M : Modules) {
+    std::vector<ByteInterval*> Intervals;
+    for (ByteInterval& BI : M->byte_intervals()) {
+      ASSERT_TRUE(BI.getAddress());
+      Intervals.push_back(&BI);
+    }
+    std::sort(Intervals.begin(), Intervals.end(),
+              [](ByteInterval* L, ByteInterval* R) {
+                return *L->getAddress() < *R->getAddress();
+              });
+    for (size_t I = 1; I < Intervals.size(); ++I) {
+      EXPECT_LE(*Intervals[I - 1]->getAddress() + Intervals[I - 1]->getSize(),
+                *Intervals[I]->getAddress());
+    }
+    EXPECT_FALSE(layoutRequired(*M));
+  }
+  for (Symbol* S : Integral) {
+    ASSERT_TRUE(S->hasReferent());
+    auto* Block = S->getReferent<DataBlock>();
+    ASSERT_TRUE(Block);
+    EXPECT_EQ(S->getModule(),
+              Block->getByteInterval()->getSection()->getModule());
+    EXPECT_EQ(6, Block->getOffset());
+  }
+}
+
+TEST(Unit_Layout, layoutModuleIncremental) {
+  Context C;
+  Module* M = Module::Create(C, "test");
+  Section* S1 = M->addSection(C, ".test1");
+  Section* S2 = M->addSection(C, ".test2");
+  Section* S3 = M->addSection(C, ".test3");
+  ByteInterval* BI1 = S1->addByteInterval(C, Addr(0x100), 0x10);
+  ByteInterval* BI2 = S2->addByteInterval(C, Addr(0x110), 0x10);
+  ByteInterval* BI3 = S3->addByteInterval(C, Addr(0x120), 0x10);
+
+  // Nothing moves if nothing overlaps.
+  size_t Moved = 1;
+  layoutModuleIncremental(C, *M, &Moved);
+  EXPECT_EQ(0, Moved);
+  EXPECT_EQ(Addr(0x100), BI1->getAddress());
+  EXPECT_EQ(Addr(0x110), BI2->getAddress());
+  EXPECT_EQ(Addr(0x120), BI3->getAddress());
+
+  // Growing the first section moves the sections after it, but not the first.
+  BI1->setSize(0x18);
+  layoutModuleIncremental(C, *M, &Moved);
+  EXPECT_EQ(2, Moved);
+  EXPECT_EQ(Addr(0x100), BI1->getAddress());
+  EXPECT_LE(*BI1->getAddress() + BI1->getSize(), *BI2->getAddress());
+  EXPECT_LE(*BI2->getAddress() + BI2->getSize(), *BI3->getAddress());
+
+  // A new section without an address is placed after the others.
+  Section* S4 = M->addSection(C, ".test4");
+  ByteInterval* BI4 = S4->addByteInterval(C, 4);
+  layoutModuleIncremental(C, *M, &Moved);
+  EXPECT_EQ(1, Moved);
+  ASSERT_TRUE(BI4->getAddress());
+  EXPECT_LE(*BI3->getAddress() + BI3->getSize(), *BI4->getAddress());
+  EXPECT_FALSE(layoutRequired(*M));
+}
+
 int main(int argc, char** argv) {
   registerAuxDataTypes();
 
@@ -18,6 +18,7 @@
 #include "Arm64PrettyPrinter.hpp"
 #include "AuxDataSchema.hpp"
 #include "AuxDataUtils.hpp"
+#include "InstructionProperties.hpp"
 #include "StringUtils.hpp"
 
 #include <capstone/capstone.h>
@@ -80,7 +81,7 @@ void Arm64PrettyPrinter::printInstruction(std::ostream& os,
 
   ////////////////////////////////////////////////////////////////////
   // special cases
-  std::string opcode = std::string();
+  std::string_view opcode;
 
   if (inst.id == ARM64_INS_NOP) {
     InstructLine << "  " << syntax.nop();
@@ -101,9 +102,7 @@ void Arm64PrettyPrinter::printInstruction(std::ostream& os,
     // to print something that can be reassembled, reverse this substitution
     // and print an adrp.
 
-    const gtirb::SymbolicExpression* Symex =
-        block.getByteInterval()->getSymbolicExpression(
-            ea - *block.getByteInterval()->getAddress());
+    const gtirb::SymbolicExpression* Symex = getSymbolicOperand(block, ea);
     if (Symex != nullptr) {
       const gtirb::SymAddrConst* Symaddr = this->getSymbolicImmediate(Symex);
       if (Symaddr != nullptr &&
@@ -123,7 +122,7 @@ void Arm64PrettyPrinter::printInstruction(std::ostream& os,
   ////////////////////////////////////////////////////////////////////
 
   if (opcode.empty()) {
-    opcode = ascii_str_tolower(inst.mnemonic);
+    opcode = getMnemonicText(inst);
   }
 
   InstructLine << "  " << opcode << ' ';
@@ -265,23 +264,10 @@ void Arm64PrettyPrinter::printOperandList(std::ostream& os,
     }
   };
 
-  // This set of special cases is required to handle conditional operands,
-  // which capstone does not represent as an explicit operand. See the capstone
-  // issue: https://github.com/capstone-engine/capstone/issues/1889
-  auto isCondInstr = [](const arm64_insn opcode) {
-    static std::vector<arm64_insn> cond_instrs{
-        ARM64_INS_CCMN,   ARM64_INS_CCMP,  ARM64_INS_CINC,  ARM64_INS_CINV,
-        ARM64_INS_CNEG,   ARM64_INS_CSEL,  ARM64_INS_CSET,  ARM64_INS_CSETM,
-        ARM64_INS_CSINC,  ARM64_INS_CSINV, ARM64_INS_CSNEG, ARM64_INS_FCCMP,
-        ARM64_INS_FCCMPE, ARM64_INS_FCSEL,
-    };
-
-    return (std::find(std::begin(cond_instrs), std::end(cond_instrs), opcode) !=
-            std::end(cond_instrs));
-  };
-
+  // Conditional operands are not represented explicitly by capstone; see
+  // ConditionCodeOperand.
   if (inst.detail->arm64.cc != ARM64_CC_INVALID &&
-      isCondInstr(static_cast<arm64_insn>(inst.id))) {
+      Arm64Instructions.has(inst.id, ConditionCodeOperand)) {
     std::string cc = arm64Cc2String(inst.detail->arm64.cc);
     os << ',' << cc;
   }
@@ -301,15 +287,13 @@ void Arm64PrettyPrinter::printOperand(std::ostream& os,
     return;
   case ARM64_OP_IMM:
     if (finalOp) {
-      uint64_t Offset = ea - *block.getByteInterval()->getAddress();
-      symbolic = block.getByteInterval()->getSymbolicExpression(Offset);
+      symbolic = getSymbolicOperand(block, ea);
     }
     printOpImmediate(os, symbolic, inst, index);
     return;
   case ARM64_OP_MEM:
     if (finalOp) {
-      uint64_t Offset = ea - *block.getByteInterval()->getAddress();
-      symbolic = block.getByteInterval()->getSymbolicExpression(Offset);
+      symbolic = getSymbolicOperand(block, ea);
     }
     printOpIndirect(os, symbolic, inst, index);
     return;
@@ -362,7 +346,7 @@ void Arm64PrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
   const cs_arm64_op& op = inst.detail->arm64.operands[index];
   assert(op.type == ARM64_OP_REG &&
          "printOpRegdirect called without a register operand");
-  os << getRegisterName(op.reg);
+  os << getRegisterText(op.reg);
 
   if (op.vas != ARM64_VAS_INVALID) {
     auto arm64Vas2String = [](arm64_vas vas) {
@@ -433,8 +417,7 @@ void Arm64PrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
     os << ", ";
     printExtender(os, op.ext, op.shift.type, op.shift.value);
   } else {
-    std::string opcode = ascii_str_tolower(inst.mnemonic);
-    opcode = opcode.substr(0, 3);
+    std::string_view opcode = getMnemonicText(inst).substr(0, 3);
     if (op.shift.type != ARM64_SFT_INVALID && op.shift.value != 0) {
       os << ", ";
       // In case where opcode is the same as one of arm64_shifters (e.g., lsl),
@@ -443,7 +426,7 @@ void Arm64PrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
       if (shift_type != opcode)
         os << shift_type << " ";
       if (op.shift.value >= 64)
-        os << getRegisterName(op.shift.value);
+        os << getRegisterText(op.shift.value);
       else
         os << "#" << op.shift.value;
     }
@@ -464,7 +447,8 @@ void Arm64PrettyPrinter::printOpImmediate(
     }
     this->printSymbolicExpression(os, s, !is_jump);
   } else {
-    os << "#" << op.imm;
+    os << '#';
+    write_dec(os, op.imm);
     if (op.shift.type != ARM64_SFT_INVALID && op.shift.value != 0) {
       os << ",";
       printShift(os, op.shift.type, op.shift.value);
@@ -487,7 +471,7 @@ void Arm64PrettyPrinter::printOpIndirect(
   // Base register
   if (op.mem.base != ARM64_REG_INVALID) {
     first = false;
-    os << getRegisterName(op.mem.base);
+    os << getRegisterText(op.mem.base);
   }
 
   // Displacement (constant)
@@ -511,7 +495,7 @@ void Arm64PrettyPrinter::printOpIndirect(
       os << ",";
     }
     first = false;
-    os << getRegisterName(op.mem.index);
+    os << getRegisterText(op.mem.index);
   }
 
   // Add extend / shift
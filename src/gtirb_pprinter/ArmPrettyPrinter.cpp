@@ -18,7 +18,10 @@
 #include "AuxDataUtils.hpp"
 #include "StringUtils.hpp"
 #include "driver/Logger.h"
+#include <algorithm>
+#include <charconv>
 #include <iostream>
+#include <optional>
 
 namespace gtirb_pprint {
 
@@ -57,13 +60,63 @@ std::string ArmSyntax::formatSymbolName(const std::string& S) const {
   return replaceSpecialChars(S);
 }
 
+const std::vector<size_t> ArmCsModes = {
+    CS_MODE_ARM | CS_MODE_V8,
+    CS_MODE_ARM,
+};
+const std::vector<size_t> ThumbCsModes = {
+    CS_MODE_THUMB | CS_MODE_V8,
+    CS_MODE_THUMB | CS_MODE_V8 | CS_MODE_MCLASS,
+    CS_MODE_THUMB,
+    CS_MODE_THUMB | CS_MODE_MCLASS,
+};
+
+ArmCsModeOrder::ArmCsModeOrder(
+    std::vector<size_t> Modes_,
+    const std::map<std::string, std::string>& ArchInfo)
+    : Modes(std::move(Modes_)) {
+  std::optional<bool> MClass;
+  if (auto It = ArchInfo.find("Profile"); It != ArchInfo.end()) {
+    MClass = It->second == "Microcontroller" || It->second == "M";
+  }
+  std::optional<bool> V8;
+  if (auto It = ArchInfo.find("Arch"); It != ArchInfo.end()) {
+    // e.g. "v7", "ARMv8-A", or "v8.1-M.main"; ignore anything else.
+    const std::string& Arch = It->second;
+    size_t Start = Arch.find_first_of("0123456789");
+    unsigned long Version = 0;
+    if (Start != std::string::npos &&
+        std::from_chars(Arch.data() + Start, Arch.data() + Arch.size(),
+                        Version)
+                .ec == std::errc()) {
+      V8 = Version >= 8;
+    }
+  }
+
+  auto Rank = [&](size_t Mode) {
+    int R = 0;
+    if (MClass && ((Mode & CS_MODE_MCLASS) != 0) != *MClass) {
+      R += 2;
+    }
+    if (V8 && ((Mode & CS_MODE_V8) != 0) != *V8) {
+      R += 1;
+    }
+    return R;
+  };
+  std::stable_sort(Modes.begin(), Modes.end(), [&](size_t A, size_t B) {
+    return Rank(A) < Rank(B);
+  });
+}
+
 ArmPrettyPrinter::ArmPrettyPrinter(gtirb::Context& context_,
                                    const gtirb::Module& module_,
                                    const ArmSyntax& syntax_,
 
                                    const PrintingPolicy& policy_)
     : ElfPrettyPrinter(context_, module_, syntax_, policy_),
-      armSyntax(syntax_) {
+      armSyntax(syntax_),
+      ArmModes(ArmCsModes, aux_data::getArchInfo(module_)),
+      ThumbModes(ThumbCsModes, aux_data::getArchInfo(module_)) {
   // Setup Capstone.
   [[maybe_unused]] cs_err err =
       cs_open(CS_ARCH_ARM, (cs_mode)(CS_MODE_ARM), &this->csHandle);
@@ -86,17 +139,6 @@ void ArmPrettyPrinter::setDecodeMode(std::ostream& Os,
   }
 }
 
-const std::vector<size_t> ArmCsModes = {
-    CS_MODE_ARM | CS_MODE_V8,
-    CS_MODE_ARM,
-};
-const std::vector<size_t> ThumbCsModes = {
-    CS_MODE_THUMB | CS_MODE_V8,
-    CS_MODE_THUMB | CS_MODE_V8 | CS_MODE_MCLASS,
-    CS_MODE_THUMB,
-    CS_MODE_THUMB | CS_MODE_MCLASS,
-};
-
 void ArmPrettyPrinter::printBlockContents(std::ostream& Os,
                                           const gtirb::CodeBlock& X,
                                           uint64_t Offset) {
@@ -107,8 +149,8 @@ void ArmPrettyPrinter::printBlockContents(std::ostream& Os,
   gtirb::Addr Addr = *X.getAddress();
   Os << '\n';
 
-  const std::vector<size_t>& CsModes =
-      X.getDecodeMode() != gtirb::DecodeMode::Thumb ? ArmCsModes : ThumbCsModes;
+  const ArmCsModeOrder& CsModes =
+      X.getDecodeMode() != gtirb::DecodeMode::Thumb ? ArmModes : ThumbModes;
 
   std::unique_ptr<cs_insn, std::function<void(cs_insn*)>> InsnPtr;
   size_t InsnCount = 0;
@@ -121,9 +163,10 @@ void ArmPrettyPrinter::printBlockContents(std::ostream& Os,
   // because it is not a supported instruction on M-profile devices.
   //
   // This loop is to try out multiple CS modes to see if decoding succeeds.
-  // Currently, this is done only when the arch type info is not available.
+  // The modes matching the `archInfo' AuxData table, if present, are tried
+  // first (see ArmCsModeOrder).
   bool Success = false;
-  for (size_t CsMode : CsModes) {
+  for (size_t CsMode : CsModes.modes()) {
     cs_insn* Insn = nullptr;
 
     cs_option(this->csHandle, CS_OPT_MODE, CsMode);
@@ -298,12 +341,12 @@ void ArmPrettyPrinter::printInstruction(std::ostream& os,
   printComments(InstructLine, offset, inst.size);
   printCFIDirectives(InstructLine, offset);
   printEA(InstructLine, ea);
-  std::string opcode = ascii_str_tolower(inst.mnemonic);
-  if (auto index = opcode.rfind(".w"); index != std::string::npos)
+  std::string_view opcode = getMnemonicText(inst);
+  if (auto index = opcode.rfind(".w"); index != std::string_view::npos)
     opcode = opcode.substr(0, index);
 
-  auto isItInstr = [](const std::string& i) {
-    static const std::vector<std::string> it_instrs{
+  auto isItInstr = [](std::string_view i) {
+    static constexpr std::string_view it_instrs[]{
         "it",    "itt",   "ite",   "ittt",  "itte",  "itet",  "itee", "itttt",
         "ittte", "ittet", "ittee", "itett", "itete", "iteet", "iteee"};
     return (std::find(std::begin(it_instrs), std::end(it_instrs), i) !=
@@ -372,7 +415,7 @@ void ArmPrettyPrinter::printOperandList(std::ostream& os,
       if (op.type == ARM_OP_MEM) {
         os << " }, [";
         if (op.mem.base != ARM_REG_INVALID) {
-          os << getRegisterName(op.mem.base);
+          os << getRegisterText(op.mem.base);
         }
         // The disp is for alignment for VLDn and VSTn instructions.
         if (op.mem.disp != 0) {
@@ -433,8 +476,7 @@ void ArmPrettyPrinter::printOperand(std::ostream& os,
   case ARM_OP_IMM:
   case ARM_OP_PIMM:
   case ARM_OP_CIMM: {
-    symbolic = block.getByteInterval()->getSymbolicExpression(
-        ea - *block.getByteInterval()->getAddress());
+    symbolic = getSymbolicOperand(block, ea);
     printOpImmediate(os, symbolic, inst, index);
     return;
   }
@@ -443,8 +485,7 @@ void ArmPrettyPrinter::printOperand(std::ostream& os,
     return;
   }
   case ARM_OP_MEM: {
-    symbolic = block.getByteInterval()->getSymbolicExpression(
-        ea - *block.getByteInterval()->getAddress());
+    symbolic = getSymbolicOperand(block, ea);
     printOpIndirect(os, symbolic, inst, index);
     return;
   }
@@ -661,10 +702,9 @@ void ArmPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
   if (op.type == ARM_OP_SYSREG) {
     os << armSysReg2String(op.reg);
   } else {
-    os << getRegisterName(op.reg);
+    os << getRegisterText(op.reg);
     std::string shift_type = armShifter2String(op.shift.type);
-    std::string opcode = ascii_str_tolower(inst.mnemonic);
-    opcode = opcode.substr(0, 3);
+    std::string_view opcode = getMnemonicText(inst).substr(0, 3);
     if (op.shift.value != 0) {
       os << ", ";
       // In case where opcode is the same as one of arm_shifters (e.g., lsl),
@@ -672,7 +712,7 @@ void ArmPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
       if (shift_type != "" && shift_type != opcode)
         os << shift_type << " ";
       if (op.shift.value > 32)
-        os << getRegisterName(op.shift.value);
+        os << getRegisterText(op.shift.value);
       else
         os << "#" << op.shift.value;
     }
@@ -707,7 +747,7 @@ void ArmPrettyPrinter::printOpImmediate(
     else if (op.type == ARM_OP_CIMM)
       os << "cr";
     // The operand is just a number.
-    os << op.imm;
+    write_dec(os, op.imm);
   }
 }
 
@@ -735,7 +775,7 @@ void ArmPrettyPrinter::printOpIndirect(
 
   if (op.mem.base != ARM_REG_INVALID) {
     first = false;
-    os << getRegisterName(op.mem.base);
+    os << getRegisterText(op.mem.base);
   }
 
   if (op.mem.index != ARM_REG_INVALID) {
@@ -744,7 +784,7 @@ void ArmPrettyPrinter::printOpIndirect(
     first = false;
     if (op.mem.scale == -1)
       os << "-";
-    os << getRegisterName(op.mem.index);
+    os << getRegisterText(op.mem.index);
   }
 
   if (op.shift.value != 0 && op.shift.type != ARM_SFT_INVALID) {
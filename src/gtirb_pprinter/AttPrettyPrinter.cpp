@@ -80,7 +80,7 @@ void AttPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
   if (cs_insn_group(this->csHandle, &inst, CS_GRP_CALL) ||
       cs_insn_group(this->csHandle, &inst, CS_GRP_JUMP))
     os << '*';
-  os << getRegisterName(op.reg);
+  os << getRegisterText(op.reg);
 }
 
 void AttPrettyPrinter::printSymbolicExpression(
@@ -129,12 +129,14 @@ void AttPrettyPrinter::printOpImmediate(
                                                !ReferencesCode);
   } else {
     // Print a hex-formatted integer.
-    std::ios_base::fmtflags Flags = Stream.flags();
-    if (ReferencesCode) {
-      Stream << std::setbase(16) << std::showbase;
+    if (!ReferencesCode) {
+      write_dec(Stream, Op.imm);
+    } else if (Op.imm == 0) {
+      Stream << '0';
+    } else {
+      Stream << "0x";
+      write_hex(Stream, static_cast<uint64_t>(Op.imm));
     }
-    Stream << Op.imm;
-    Stream.flags(Flags);
   }
 }
 
@@ -155,7 +157,7 @@ void AttPrettyPrinter::printOpIndirect(
     os << '*';
 
   if (has_segment) {
-    os << getRegisterName(op.mem.segment) << ':';
+    os << getRegisterText(op.mem.segment) << ':';
   }
 
   if (const auto* sac = std::get_if<gtirb::SymAddrConst>(symbolic)) {
@@ -171,11 +173,10 @@ void AttPrettyPrinter::printOpIndirect(
   } else {
     // Displacement is numeric.
     if (!has_segment && !has_base && !has_index) {
-      std::ios_base::fmtflags flags = os.flags();
-      os << "0x" << std::hex << op.mem.disp;
-      os.flags(flags);
+      os << "0x";
+      write_hex(os, static_cast<uint64_t>(op.mem.disp));
     } else if (op.mem.disp != 0 || has_segment) {
-      os << op.mem.disp;
+      write_dec(os, op.mem.disp);
     } else {
       // Print nothing. There is no segment register and the base or index
       // register will be printed, so the zero displacement is implicit.
@@ -186,9 +187,9 @@ void AttPrettyPrinter::printOpIndirect(
   if (has_base || has_index) {
     os << '(';
     if (has_base)
-      os << getRegisterName(op.mem.base);
+      os << getRegisterText(op.mem.base);
     if (has_index) {
-      os << ',' << getRegisterName(op.mem.index);
+      os << ',' << getRegisterText(op.mem.index);
       if (op.mem.scale != 1)
         os << ',' << op.mem.scale;
     }
@@ -125,6 +125,10 @@ void setBinaryType(gtirb::Module& Module, const std::vector<std::string>& Vec) {
   }
 }
 
+std::map<std::string, std::string> getArchInfo(const gtirb::Module& Module) {
+  return util::getOrDefault<gtirb::schema::ArchInfo>(Module);
+}
+
 std::map<gtirb::UUID, gtirb::UUID>
 getSymbolForwarding(const gtirb::Module& Module) {
   return util::getOrDefault<gtirb::schema::SymbolForwarding>(Module);
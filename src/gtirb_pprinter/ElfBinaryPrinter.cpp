@@ -18,15 +18,23 @@
 #include "ArmPrettyPrinter.hpp"
 #include "AuxDataSchema.hpp"
 #include "AuxDataUtils.hpp"
+#include "ElfDummySOWriter.hpp"
 #include "ElfPrettyPrinter.hpp"
 #include "ElfVersionScriptPrinter.hpp"
 #include "FileUtils.hpp"
 #include "Mips32PrettyPrinter.hpp"
+#include "Parallel.hpp"
 #include "driver/Logger.h"
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
 #include <boost/filesystem.hpp>
+#include <cctype>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 #include <regex>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -104,6 +112,9 @@ getISASyntax(const gtirb::ISA ISA) {
   }
 }
 
+// Serializes log messages of dummy .so libraries generated concurrently.
+static std::mutex DummySOLogMutex;
+
 bool ElfBinaryPrinter::generateDummySO(
     const gtirb::Module& Module, const std::string& LibDir,
     const std::string& Lib, const std::vector<SymbolGroup>& SymGroups) const {
@@ -115,8 +126,10 @@ bool ElfBinaryPrinter::generateDummySO(
   auto LibPath = boost::filesystem::path(LibDir) / Lib;
   bool EmittedSymvers = false;
 
+  // The assembly is built in memory first so that it can be used as part of
+  // the dummy-so cache key.
+  std::stringstream AsmFile;
   {
-    std::ofstream AsmFile(AsmFilePath.string());
     AsmFile << "# Generated dummy file for .so undefined symbols\n";
 
     std::unique_ptr<gtirb_pprint::ElfSyntax> Syntax =
@@ -139,6 +152,7 @@ bool ElfBinaryPrinter::generateDummySO(
           if (auto CopySymRange = Sym->getModule()->findSymbols(CopyName)) {
             SymInfo = aux_data::getElfSymbolInfo(*(CopySymRange.begin()));
           } else {
+            std::lock_guard<std::mutex> Lock(DummySOLogMutex);
             LOG_ERROR << "Symbol not in symbol table [" << Sym->getName()
                       << "] while generating dummy SO\n";
             return false;
@@ -148,6 +162,7 @@ bool ElfBinaryPrinter::generateDummySO(
         if (!SymSize) {
           SymSize = SymInfo->Size;
         } else if (*SymSize != SymInfo->Size) {
+          std::lock_guard<std::mutex> Lock(DummySOLogMutex);
           LOG_ERROR << "Symbol group has mismatched sizes; " << Name << " is "
                     << SymInfo->Size << " bytes, but had " << *SymSize
                     << " bytes\n";
@@ -206,6 +221,7 @@ bool ElfBinaryPrinter::generateDummySO(
             };
         auto TypeNameIt = TypeNameConversion.find(SymType);
         if (TypeNameIt == TypeNameConversion.end()) {
+          std::lock_guard<std::mutex> Lock(DummySOLogMutex);
           LOG_ERROR << "Unknown type: " << SymType
                     << " for symbol: " << Sym->getName() << "\n";
           return false;
@@ -227,6 +243,7 @@ bool ElfBinaryPrinter::generateDummySO(
       AsmFile << ".skip " << Space << "\n";
     }
   }
+  std::ofstream(AsmFilePath.string()) << AsmFile.str();
 
   std::vector<std::string> Args;
   Args.push_back("-o");
@@ -239,27 +256,60 @@ bool ElfBinaryPrinter::generateDummySO(
   addArchBuildArgs(Module, Args);
 
   TempFile VersionScript(".map");
+  bool UseVersionScript = false;
   if (EmittedSymvers) {
     if (!Printer.getIgnoreSymbolVersions()) {
       // A version script is only needed if we define versioned symbols.
       if (gtirb_pprint::printVersionScriptForDummySo(Module, VersionScript)) {
         Args.push_back("-Wl,--version-script=" + VersionScript.fileName());
+        UseVersionScript = true;
       }
     }
   }
   VersionScript.close();
 
+  // The dummy library is fully determined by its assembly, its version script,
+  // the compiler, and the architecture flags, so identical libraries can be
+  // reused across runs.
+  std::optional<FileCache> Cache;
+  std::string CacheKey;
+  if (!DummySOCacheDir.empty()) {
+    Cache.emplace(DummySOCacheDir);
+    std::vector<std::string> KeyInputs{compiler, AsmFile.str()};
+    if (UseVersionScript) {
+      std::ifstream VersionScriptFile(VersionScript.fileName());
+      std::stringstream VersionScriptText;
+      VersionScriptText << VersionScriptFile.rdbuf();
+      KeyInputs.push_back(VersionScriptText.str());
+    } else {
+      KeyInputs.push_back("");
+    }
+    addArchBuildArgs(Module, KeyInputs);
+    CacheKey = FileCache::key(KeyInputs);
+
+    if (Cache->fetch(CacheKey, LibPath.string())) {
+      std::lock_guard<std::mutex> Lock(DummySOLogMutex);
+      LOG_INFO << "Using cached dummy .so for " << Lib << "\n";
+      return true;
+    }
+  }
+
   if (std::optional<int> Ret = execute(compiler, Args)) {
     if (*Ret) {
-      std::cerr << "ERROR: Compiler returned " << *Ret
-                << " for dummy .so: " << Lib << "\n";
+      std::lock_guard<std::mutex> Lock(DummySOLogMutex);
+      LOG_ERROR << "Compiler returned " << *Ret << " for dummy .so: " << Lib
+                << "\n";
       return false;
     }
 
+    if (Cache) {
+      Cache->store(CacheKey, LibPath.string());
+    }
     return true;
   }
 
-  std::cerr << "ERROR: Failed to run compiler for dummy .so: " << Lib << "\n";
+  std::lock_guard<std::mutex> Lock(DummySOLogMutex);
+  LOG_ERROR << "Failed to run compiler for dummy .so: " << Lib << "\n";
   return false;
 }
 
@@ -469,17 +519,50 @@ bool ElfBinaryPrinter::prepareDummySOLibs(
 
   LibArgs.push_back("-L" + LibDir);
 
-  // Generate the .so files
+  // Generate the .so files. Each library is independent of the others, so the
+  // assembly and the compiler invocation for each one run on a bounded pool of
+  // workers. AllocatedSymbols is fully populated up front so that the workers
+  // only read from it.
   for (const auto& Lib : Libs) {
-    if (!generateDummySO(Module, LibDir, Lib, AllocatedSymbols[Lib])) {
-      LOG_ERROR << "Failed generating dummy .so for " << Lib << "\n";
-      return false;
+    AllocatedSymbols.try_emplace(Lib);
+  }
+  // The workers read symbol information and versions from AuxData, which
+  // gtirb unpacks on first access. Unpack those tables here, on this thread,
+  // so that the workers' reads do not race with it.
+  Module.getAuxData<gtirb::schema::ElfSymbolInfo>();
+  Module.getAuxData<gtirb::provisional_schema::ElfSymbolVersions>();
+  // Only the x86-64 libraries written directly have been checked against a
+  // real linker; assemble them for other ISAs.
+  bool Native = useNativeDummySO && Module.getISA() == gtirb::ISA::X64;
+  if (useNativeDummySO && !Native) {
+    LOG_WARNING << "Native dummy .so generation is only supported for x86-64; "
+                   "assembling the libraries instead.\n";
+  }
+  std::vector<char> Generated(Libs.size(), false);
+  gtirb_pprint::parallelFor(Libs.size(), [&](size_t I) {
+    const std::string& Lib = Libs[I];
+    if (Native) {
+      auto LibPath = boost::filesystem::path(LibDir) / Lib;
+      Generated[I] =
+          writeDummySO(Module, LibPath.string(), Lib, AllocatedSymbols.at(Lib),
+                       Printer.getIgnoreSymbolVersions());
+    } else {
+      Generated[I] =
+          generateDummySO(Module, LibDir, Lib, AllocatedSymbols.at(Lib));
     }
-
-    LibArgs.push_back("-l:" + Lib);
+  });
+
+  // Report every failure, not just the first one.
+  bool Success = true;
+  for (size_t I = 0; I < Libs.size(); ++I) {
+    if (!Generated[I]) {
+      LOG_ERROR << "Failed generating dummy .so for " << Libs[I] << "\n";
+      Success = false;
+    }
+    LibArgs.push_back("-l:" + Libs[I]);
   }
 
-  return true;
+  return Success;
 }
 
 void ElfBinaryPrinter::addOrigLibraryArgs(const gtirb::Module& module,
@@ -564,6 +647,160 @@ collectGlobalVisibleSymsExported(gtirb::Context& Ctx, gtirb::Module& Module) {
   return ExportedSymbols;
 }
 
+// Linkers tried, in order, when the linker is detected automatically.
+static const std::vector<std::string> FastLinkers = {"mold", "lld"};
+
+// Rewrite single-dash linker options with a joined value (e.g. -Wl,-init=foo)
+// into the separate-argument form, which every supported linker accepts.
+static std::string translateLinkerArg(const std::string& Arg) {
+  static const std::vector<std::string> JoinedOptions = {"-init", "-fini",
+                                                         "-soname"};
+  const std::string Prefix = "-Wl,";
+  if (Arg.compare(0, Prefix.size(), Prefix) != 0) {
+    return Arg;
+  }
+  for (const std::string& Option : JoinedOptions) {
+    if (Arg.compare(Prefix.size(), Option.size() + 1, Option + "=") == 0) {
+      return Prefix + Option + "," +
+             Arg.substr(Prefix.size() + Option.size() + 1);
+    }
+  }
+  return Arg;
+}
+
+// Collect the linker options passed with -Wl, spelled the way linkers list
+// them in their --help output: "--version-script", "-init", "-z execstack".
+static std::vector<std::string>
+getLinkerOptions(const std::vector<std::string>& Args) {
+  std::vector<std::string> Options;
+  const std::string Prefix = "-Wl,";
+  for (const std::string& Arg : Args) {
+    if (Arg.compare(0, Prefix.size(), Prefix) != 0) {
+      continue;
+    }
+    std::vector<std::string> Tokens;
+    std::string LinkerArgs = Arg.substr(Prefix.size());
+    boost::split(Tokens, LinkerArgs, boost::is_any_of(","));
+    for (size_t I = 0; I < Tokens.size(); ++I) {
+      const std::string& Token = Tokens[I];
+      if (Token.empty() || Token[0] != '-') {
+        // The value of the preceding option.
+        continue;
+      }
+      std::string Name = Token.substr(0, Token.find('='));
+      if (Name == "-z" && I + 1 < Tokens.size()) {
+        const std::string& Keyword = Tokens[++I];
+        Name += " " + Keyword.substr(0, Keyword.find('='));
+      }
+      Options.push_back(Name);
+    }
+  }
+  return Options;
+}
+
+// Return true if Help, the --help output of a linker, lists Token as a whole
+// word, i.e. not as part of a longer option name.
+static bool helpLists(const std::string& Help, const std::string& Token) {
+  auto isNameChar = [](char C) {
+    return std::isalnum(static_cast<unsigned char>(C)) || C == '-' || C == '_';
+  };
+  for (size_t Pos = Help.find(Token); Pos != std::string::npos;
+       Pos = Help.find(Token, Pos + 1)) {
+    size_t End = Pos + Token.size();
+    if ((Pos == 0 || !isNameChar(Help[Pos - 1])) &&
+        (End == Help.size() || !isNameChar(Help[End]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The -z keywords this printer passes itself. lld documents "-z <option>"
+// without listing keywords, so these are trusted with such a linker; any other
+// keyword must be listed explicitly.
+static const std::vector<std::string> EmittedZKeywords = {
+    "execstack", "noexecstack", "stack-size"};
+
+// Return true if Help, the --help output of a linker, documents Option.
+static bool linkerSupports(const std::string& Help, const std::string& Option) {
+  if (Option.compare(0, 3, "-z ") == 0) {
+    if (helpLists(Help, Option)) {
+      return true;
+    }
+    std::string Keyword = Option.substr(3);
+    return helpLists(Help, "-z <option>") &&
+           std::find(EmittedZKeywords.begin(), EmittedZKeywords.end(),
+                     Keyword) != EmittedZKeywords.end();
+  }
+  // Linkers list options with one dash or two, and some write "--[no-]X" for
+  // both X and its negation.
+  std::string Name = Option.substr(Option.find_first_not_of('-'));
+  auto documents = [&Help](const std::string& Spelling) {
+    return helpLists(Help, "-" + Spelling) || helpLists(Help, "--" + Spelling);
+  };
+  if (Name.compare(0, 3, "no-") == 0 && documents("[no-]" + Name.substr(3))) {
+    return true;
+  }
+  return documents(Name) || documents("[no-]" + Name);
+}
+
+const std::optional<std::string>&
+ElfBinaryPrinter::getLinkerHelp(const std::string& Candidate) const {
+  auto [It, Inserted] = LinkerHelps.try_emplace(
+      std::make_pair(compiler, Candidate), std::nullopt);
+  if (Inserted) {
+    std::string Help;
+    std::optional<int> Ret =
+        execute(compiler, {"-fuse-ld=" + Candidate, "-Wl,--help"}, Help);
+    if (Ret && *Ret == 0) {
+      It->second = std::move(Help);
+    }
+  }
+  return It->second;
+}
+
+void ElfBinaryPrinter::useLinker(std::vector<std::string>& Args) const {
+  if (Linker.empty() || Linker == "default") {
+    return;
+  }
+  std::vector<std::string> Candidates =
+      Linker == "auto" ? FastLinkers : std::vector<std::string>{Linker};
+
+  std::vector<std::string> Translated;
+  std::transform(Args.begin(), Args.end(), std::back_inserter(Translated),
+                 translateLinkerArg);
+  std::vector<std::string> Options = getLinkerOptions(Translated);
+
+  for (const std::string& Candidate : Candidates) {
+    const std::optional<std::string>& Help = getLinkerHelp(Candidate);
+    if (!Help) {
+      if (Linker != "auto") {
+        LOG_WARNING << "The linker '" << Candidate
+                    << "' cannot be used with '" << compiler
+                    << "'; using the default linker.\n";
+      }
+      continue;
+    }
+    auto Unsupported =
+        std::find_if(Options.begin(), Options.end(),
+                     [&Help](const std::string& Option) {
+                       return !linkerSupports(*Help, Option);
+                     });
+    if (Unsupported != Options.end()) {
+      LOG_WARNING << "The linker '" << Candidate << "' does not support '"
+                  << *Unsupported << "'; not using it.\n";
+      continue;
+    }
+    LOG_INFO << "Linking with " << Candidate << "\n";
+    Args = std::move(Translated);
+    Args.insert(Args.begin(), "-fuse-ld=" + Candidate);
+    return;
+  }
+  if (Linker == "auto") {
+    LOG_INFO << "No faster linker found; using the default linker.\n";
+  }
+}
+
 std::vector<std::string> ElfBinaryPrinter::buildCompilerArgs(
     std::string outputFilename, const std::vector<TempFile>& asmPaths,
     gtirb::Module& module, const std::vector<std::string>& libArgs) const {
@@ -615,6 +852,8 @@ std::vector<std::string> ElfBinaryPrinter::buildCompilerArgs(
   args.insert(args.end(), Policy.compilerArguments.begin(),
               Policy.compilerArguments.end());
 
+  useLinker(args);
+
   if (debug) {
     std::cout << "Compiler arguments: ";
     for (auto i : args)
@@ -624,8 +863,30 @@ std::vector<std::string> ElfBinaryPrinter::buildCompilerArgs(
   return args;
 }
 
+bool ElfBinaryPrinter::prepareObject(gtirb::Context& Context,
+                                     gtirb::Module& Module,
+                                     TempFile& ObjectFile) const {
+  if (!ObjectFile.isOpen()) {
+    return false;
+  }
+  std::ofstream& Stream = ObjectFile;
+  bool Written = Printer.writeObject(Stream, Context, Module) == 0;
+  ObjectFile.close();
+  return Written;
+}
+
 int ElfBinaryPrinter::assemble(const std::string& outputFilename,
                                gtirb::Context& ctx, gtirb::Module& mod) const {
+  if (useObjectDirect) {
+    TempFile ObjectFile(".o");
+    if (prepareObject(ctx, mod, ObjectFile)) {
+      copyFile(ObjectFile.fileName(), outputFilename);
+      return 0;
+    }
+    LOG_WARNING << "Could not write the object file directly, falling back to "
+                   "the assembler.\n";
+  }
+
   TempFile tempFile;
   if (!prepareSource(ctx, mod, tempFile)) {
     std::cerr << "ERROR: Could not write assembly into a temporary file.\n";
@@ -694,10 +955,23 @@ int ElfBinaryPrinter::link(const std::string& outputFilename,
                            gtirb::Context& ctx, gtirb::Module& module) const {
   if (debug)
     std::cout << "Generating binary file" << std::endl;
-  TempFile tempFile;
-  if (!prepareSource(ctx, module, tempFile)) {
-    LOG_ERROR << "Could not write assembly into a temporary file.\n";
-    return -1;
+  std::optional<TempFile> ObjectFile;
+  if (useObjectDirect) {
+    ObjectFile.emplace(".o");
+    if (!prepareObject(ctx, module, *ObjectFile)) {
+      LOG_WARNING << "Could not write the object file directly, falling back "
+                     "to the assembler.\n";
+      ObjectFile.reset();
+    }
+  }
+  // The assembly is only written when no object file was.
+  std::optional<TempFile> tempFile;
+  if (!ObjectFile) {
+    tempFile.emplace();
+    if (!prepareSource(ctx, module, *tempFile)) {
+      LOG_ERROR << "Could not write assembly into a temporary file.\n";
+      return -1;
+    }
   }
 
   // Prep stuff for dynamic library dependences
@@ -765,7 +1039,8 @@ int ElfBinaryPrinter::link(const std::string& outputFilename,
   DynamicList.close();
 
   std::vector<TempFile> Files;
-  Files.emplace_back(std::move(tempFile));
+  Files.emplace_back(ObjectFile ? std::move(*ObjectFile)
+                                : std::move(*tempFile));
 
   // Add -Wl,-init= and -Wl,-fini= arguments if necessary.
   // This recreates DT_INIT and DT_FINI dynamic entries.
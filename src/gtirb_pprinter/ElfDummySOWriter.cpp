@@ -0,0 +1,548 @@
+//===- ElfDummySOWriter.cpp -------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "ElfDummySOWriter.hpp"
+
+#include "AuxDataUtils.hpp"
+#include "ElfEncoding.hpp"
+#include "driver/Logger.h"
+#include <array>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace gtirb_bprint {
+
+namespace {
+
+using namespace elf;
+
+// ELF constants specific to shared objects.
+const uint32_t PT_LOAD = 1;
+const uint32_t PT_DYNAMIC = 2;
+const uint32_t PT_TLS = 7;
+const uint32_t PF_X = 1;
+const uint32_t PF_W = 2;
+const uint32_t PF_R = 4;
+
+const int64_t DT_NULL = 0;
+const int64_t DT_HASH = 4;
+const int64_t DT_STRTAB = 5;
+const int64_t DT_SYMTAB = 6;
+const int64_t DT_STRSZ = 10;
+const int64_t DT_SYMENT = 11;
+const int64_t DT_SONAME = 14;
+const int64_t DT_VERSYM = 0x6ffffff0;
+const int64_t DT_VERDEF = 0x6ffffffc;
+const int64_t DT_VERDEFNUM = 0x6ffffffd;
+const int64_t DT_MIPS_RLD_VERSION = 0x70000001;
+const int64_t DT_MIPS_FLAGS = 0x70000005;
+const int64_t DT_MIPS_BASE_ADDRESS = 0x70000006;
+const int64_t DT_MIPS_LOCAL_GOTNO = 0x7000000a;
+const int64_t DT_MIPS_SYMTABNO = 0x70000011;
+const int64_t DT_MIPS_GOTSYM = 0x70000013;
+const uint64_t RHF_NOTPOT = 0x2;
+
+const uint16_t VER_NDX_LOCAL = 0;
+const uint16_t VER_NDX_GLOBAL = 1;
+const uint16_t VER_FLG_BASE = 0x1;
+const uint16_t VERSYM_HIDDEN = 0x8000;
+const uint32_t VERDEF_SIZE = 20;
+const uint32_t VERDAUX_SIZE = 8;
+
+// Virtual address distance between the file offsets of the read-write segment
+// and its load address. This keeps the addresses of both segments congruent
+// to their file offsets modulo the largest page size of the supported ISAs.
+const uint64_t PAGE_SIZE = 0x10000;
+const uint64_t PLACEHOLDER_ALIGN = 16;
+
+uint32_t elfHash(const std::string& Name) {
+  uint32_t H = 0;
+  for (unsigned char C : Name) {
+    H = (H << 4) + C;
+    uint32_t G = H & 0xf0000000;
+    if (G) {
+      H ^= G >> 24;
+    }
+    H &= ~G;
+  }
+  return H;
+}
+
+/// Zero-filled placeholder sections that dummy symbols are defined in.
+enum Placeholder { Text, Data, TData, NumPlaceholders };
+
+struct DummySymbol {
+  std::string Name;
+  uint8_t Type;
+  uint8_t Binding;
+  Placeholder Section;
+  uint64_t Offset;
+  uint64_t Size;
+  uint16_t Version;
+};
+
+struct SectionLayout {
+  std::string Name;
+  uint32_t Type;
+  uint64_t Flags;
+  uint64_t Align;
+  uint64_t EntSize;
+  uint64_t Size;
+  uint32_t Link = 0;
+  uint32_t Info = 0;
+  uint64_t Offset = 0;
+  uint64_t Addr = 0;
+};
+
+/// Assembles the dynamic symbol table, version definitions, and placeholder
+/// contents of a dummy library into an ELF image.
+class DummySOBuilder {
+public:
+  explicit DummySOBuilder(const ElfTarget& T) : Target(T) {}
+
+  uint16_t addVersion(const std::string& Name) {
+    // Index 1 is the base version, which carries the library's name.
+    auto [It, Inserted] =
+        VersionIndices.try_emplace(Name, VersionNames.size() + 2);
+    if (Inserted) {
+      VersionNames.push_back(Name);
+    }
+    return It->second;
+  }
+
+  uint64_t allocate(Placeholder Section, uint64_t Size) {
+    uint64_t Offset = alignTo(PlaceholderSizes[Section], PLACEHOLDER_ALIGN);
+    PlaceholderSizes[Section] = Offset + Size;
+    return Offset;
+  }
+
+  void addSymbol(DummySymbol Sym) { Symbols.push_back(std::move(Sym)); }
+
+  std::vector<uint8_t> build(const std::string& SoName) const;
+
+private:
+  const ElfTarget& Target;
+  std::vector<DummySymbol> Symbols;
+  std::vector<std::string> VersionNames;
+  std::map<std::string, uint16_t> VersionIndices;
+  std::array<uint64_t, NumPlaceholders> PlaceholderSizes{};
+};
+
+std::vector<uint8_t> DummySOBuilder::build(const std::string& SoName) const {
+  const uint64_t W = Target.Is64 ? 8 : 4;
+  const uint64_t EhdrSize = Target.Is64 ? 64 : 52;
+  const uint64_t PhdrSize = Target.Is64 ? 56 : 32;
+  const uint64_t ShdrSize = Target.Is64 ? 64 : 40;
+  const uint64_t SymSize = Target.Is64 ? 24 : 16;
+  const uint64_t DynSize = 2 * W;
+  const bool HasVersions = !VersionNames.empty();
+  const bool HasTls = PlaceholderSizes[TData] > 0;
+  const bool IsMips = Target.Machine == EM_MIPS;
+  const uint64_t NumSyms = Symbols.size() + 1;
+  const uint64_t NumBuckets = std::max<uint64_t>(1, Symbols.size());
+
+  StringTable DynStr;
+  uint32_t SoNameIdx = DynStr.add(SoName);
+  std::vector<uint32_t> SymNameIdx;
+  for (const auto& Sym : Symbols) {
+    SymNameIdx.push_back(DynStr.add(Sym.Name));
+  }
+  std::vector<uint32_t> VersionNameIdx;
+  for (const auto& Name : VersionNames) {
+    VersionNameIdx.push_back(DynStr.add(Name));
+  }
+
+  // Lay out the sections: everything but the writable placeholders and the
+  // dynamic section goes in a read-only, executable segment.
+  std::vector<SectionLayout> Sections(1);
+  auto addSection = [&Sections](SectionLayout S) {
+    Sections.push_back(std::move(S));
+    return static_cast<uint32_t>(Sections.size() - 1);
+  };
+  uint32_t HashIdx =
+      addSection({".hash", SHT_HASH, SHF_ALLOC, 4, 4,
+                  (2 + NumBuckets + NumSyms) * 4});
+  uint32_t DynSymIdx = addSection(
+      {".dynsym", SHT_DYNSYM, SHF_ALLOC, W, SymSize, NumSyms * SymSize});
+  uint32_t DynStrIdx = addSection(
+      {".dynstr", SHT_STRTAB, SHF_ALLOC, 1, 0, DynStr.data().size()});
+  uint32_t VerSymIdx = 0, VerDefIdx = 0;
+  if (HasVersions) {
+    VerSymIdx = addSection(
+        {".gnu.version", SHT_GNU_VERSYM, SHF_ALLOC, 2, 2, NumSyms * 2});
+    VerDefIdx = addSection(
+        {".gnu.version_d", SHT_GNU_VERDEF, SHF_ALLOC, 4, 0,
+         (VersionNames.size() + 1) * (VERDEF_SIZE + VERDAUX_SIZE)});
+  }
+  std::array<uint32_t, NumPlaceholders> PlaceholderIdx;
+  PlaceholderIdx[Text] =
+      addSection({".text", SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR,
+                  PLACEHOLDER_ALIGN, 0, PlaceholderSizes[Text]});
+  uint32_t FirstWritableIdx = static_cast<uint32_t>(Sections.size());
+  PlaceholderIdx[TData] =
+      addSection({".tdata", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE | SHF_TLS,
+                  PLACEHOLDER_ALIGN, 0, PlaceholderSizes[TData]});
+  PlaceholderIdx[Data] =
+      addSection({".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE,
+                  PLACEHOLDER_ALIGN, 0, PlaceholderSizes[Data]});
+
+  // Build the dynamic entries; their count is independent of the addresses,
+  // which are only known once the layout is complete.
+  auto dynamicEntries = [&]() {
+    std::vector<std::pair<int64_t, uint64_t>> Entries = {
+        {DT_HASH, Sections[HashIdx].Addr},
+        {DT_STRTAB, Sections[DynStrIdx].Addr},
+        {DT_SYMTAB, Sections[DynSymIdx].Addr},
+        {DT_STRSZ, Sections[DynStrIdx].Size},
+        {DT_SYMENT, SymSize},
+        {DT_SONAME, SoNameIdx}};
+    if (HasVersions) {
+      Entries.push_back({DT_VERSYM, Sections[VerSymIdx].Addr});
+      Entries.push_back({DT_VERDEF, Sections[VerDefIdx].Addr});
+      Entries.push_back({DT_VERDEFNUM, VersionNames.size() + 1});
+    }
+    if (IsMips) {
+      Entries.push_back({DT_MIPS_RLD_VERSION, 1});
+      Entries.push_back({DT_MIPS_FLAGS, RHF_NOTPOT});
+      Entries.push_back({DT_MIPS_BASE_ADDRESS, 0});
+      Entries.push_back({DT_MIPS_LOCAL_GOTNO, 0});
+      Entries.push_back({DT_MIPS_SYMTABNO, NumSyms});
+      Entries.push_back({DT_MIPS_GOTSYM, NumSyms});
+    }
+    Entries.push_back({DT_NULL, 0});
+    return Entries;
+  };
+  uint32_t DynamicIdx = addSection({".dynamic", SHT_DYNAMIC,
+                                    SHF_ALLOC | SHF_WRITE, W, DynSize,
+                                    dynamicEntries().size() * DynSize});
+
+  StringTable ShStr;
+  for (auto& S : Sections) {
+    ShStr.add(S.Name);
+  }
+  ShStr.add(".shstrtab");
+  uint32_t ShStrIdx = addSection(
+      {".shstrtab", SHT_STRTAB, 0, 1, 0, ShStr.data().size()});
+
+  Sections[HashIdx].Link = DynSymIdx;
+  Sections[DynSymIdx].Link = DynStrIdx;
+  Sections[DynSymIdx].Info = 1; // All symbols but the null symbol are global.
+  if (HasVersions) {
+    Sections[VerSymIdx].Link = DynSymIdx;
+    Sections[VerDefIdx].Link = DynStrIdx;
+    Sections[VerDefIdx].Info = static_cast<uint32_t>(VersionNames.size() + 1);
+  }
+  Sections[DynamicIdx].Link = DynStrIdx;
+
+  const uint64_t NumPhdrs = HasTls ? 4 : 3;
+  uint64_t Offset = EhdrSize + NumPhdrs * PhdrSize;
+  uint64_t WritableStart = 0;
+  for (uint32_t I = 1; I < Sections.size(); ++I) {
+    SectionLayout& S = Sections[I];
+    if (I == FirstWritableIdx) {
+      WritableStart = alignTo(Offset, PLACEHOLDER_ALIGN);
+    }
+    Offset = alignTo(Offset, S.Align);
+    S.Offset = Offset;
+    if (I == ShStrIdx) {
+      S.Addr = 0;
+    } else {
+      S.Addr = I < FirstWritableIdx ? Offset : Offset + PAGE_SIZE;
+    }
+    Offset += S.Size;
+  }
+  const uint64_t ReadOnlyEnd = Sections[FirstWritableIdx - 1].Offset +
+                               Sections[FirstWritableIdx - 1].Size;
+  const uint64_t WritableEnd =
+      Sections[DynamicIdx].Offset + Sections[DynamicIdx].Size;
+  const uint64_t ShOff = alignTo(Offset, W);
+
+  ElfBuffer Out(Target);
+
+  // ELF header
+  Out.append("\x7f"
+             "ELF");
+  Out.u8(Target.Is64 ? 2 : 1);      // EI_CLASS
+  Out.u8(Target.BigEndian ? 2 : 1); // EI_DATA
+  Out.u8(1);                        // EI_VERSION
+  Out.padTo(16);                    // EI_OSABI, EI_ABIVERSION, EI_PAD
+  Out.u16(ET_DYN);
+  Out.u16(Target.Machine);
+  Out.u32(1);  // e_version
+  Out.word(0); // e_entry
+  Out.word(EhdrSize);
+  Out.word(ShOff);
+  Out.u32(Target.Flags);
+  Out.u16(static_cast<uint16_t>(EhdrSize));
+  Out.u16(static_cast<uint16_t>(PhdrSize));
+  Out.u16(static_cast<uint16_t>(NumPhdrs));
+  Out.u16(static_cast<uint16_t>(ShdrSize));
+  Out.u16(static_cast<uint16_t>(Sections.size()));
+  Out.u16(static_cast<uint16_t>(ShStrIdx));
+
+  // Program headers
+  auto phdr = [&](uint32_t Type, uint32_t Flags, uint64_t Off, uint64_t Addr,
+                  uint64_t Size, uint64_t Align) {
+    Out.u32(Type);
+    if (Target.Is64) {
+      Out.u32(Flags);
+    }
+    Out.word(Off);
+    Out.word(Addr);
+    Out.word(Addr);
+    Out.word(Size);
+    Out.word(Size);
+    if (!Target.Is64) {
+      Out.u32(Flags);
+    }
+    Out.word(Align);
+  };
+  phdr(PT_LOAD, PF_R | PF_X, 0, 0, ReadOnlyEnd, PAGE_SIZE);
+  phdr(PT_LOAD, PF_R | PF_W, WritableStart, WritableStart + PAGE_SIZE,
+       WritableEnd - WritableStart, PAGE_SIZE);
+  const SectionLayout& Dynamic = Sections[DynamicIdx];
+  phdr(PT_DYNAMIC, PF_R | PF_W, Dynamic.Offset, Dynamic.Addr, Dynamic.Size,
+       W);
+  if (HasTls) {
+    const SectionLayout& TDataSection = Sections[PlaceholderIdx[TData]];
+    phdr(PT_TLS, PF_R, TDataSection.Offset, TDataSection.Addr,
+         TDataSection.Size, PLACEHOLDER_ALIGN);
+  }
+
+  // .hash
+  std::vector<uint32_t> Buckets(NumBuckets, 0);
+  std::vector<uint32_t> Chains(NumSyms, 0);
+  for (uint32_t I = 1; I < NumSyms; ++I) {
+    uint32_t Bucket = elfHash(Symbols[I - 1].Name) % NumBuckets;
+    Chains[I] = Buckets[Bucket];
+    Buckets[Bucket] = I;
+  }
+  Out.padTo(Sections[HashIdx].Offset);
+  Out.u32(static_cast<uint32_t>(NumBuckets));
+  Out.u32(static_cast<uint32_t>(NumSyms));
+  for (uint32_t B : Buckets) {
+    Out.u32(B);
+  }
+  for (uint32_t C : Chains) {
+    Out.u32(C);
+  }
+
+  // .dynsym
+  Out.padTo(Sections[DynSymIdx].Offset + SymSize); // null symbol
+  for (size_t I = 0; I < Symbols.size(); ++I) {
+    const DummySymbol& Sym = Symbols[I];
+    const SectionLayout& S = Sections[PlaceholderIdx[Sym.Section]];
+    // TLS symbols are relative to the start of the TLS segment.
+    uint64_t Value = Sym.Offset + (Sym.Section == TData ? 0 : S.Addr);
+    uint8_t Info = static_cast<uint8_t>((Sym.Binding << 4) | Sym.Type);
+    uint16_t Shndx = static_cast<uint16_t>(PlaceholderIdx[Sym.Section]);
+    Out.u32(SymNameIdx[I]);
+    if (Target.Is64) {
+      Out.u8(Info);
+      Out.u8(0);
+      Out.u16(Shndx);
+      Out.u64(Value);
+      Out.u64(Sym.Size);
+    } else {
+      Out.u32(static_cast<uint32_t>(Value));
+      Out.u32(static_cast<uint32_t>(Sym.Size));
+      Out.u8(Info);
+      Out.u8(0);
+      Out.u16(Shndx);
+    }
+  }
+
+  // .dynstr
+  Out.padTo(Sections[DynStrIdx].Offset);
+  Out.append(DynStr.data());
+
+  if (HasVersions) {
+    // .gnu.version
+    Out.padTo(Sections[VerSymIdx].Offset);
+    Out.u16(VER_NDX_LOCAL);
+    for (const auto& Sym : Symbols) {
+      Out.u16(Sym.Version);
+    }
+
+    // .gnu.version_d
+    Out.padTo(Sections[VerDefIdx].Offset);
+    auto verdef = [&](uint16_t Flags, uint16_t Index, const std::string& Name,
+                      uint32_t NameIdx, bool Last) {
+      Out.u16(1); // vd_version
+      Out.u16(Flags);
+      Out.u16(Index);
+      Out.u16(1); // vd_cnt
+      Out.u32(elfHash(Name));
+      Out.u32(VERDEF_SIZE);
+      Out.u32(Last ? 0 : VERDEF_SIZE + VERDAUX_SIZE);
+      Out.u32(NameIdx); // vda_name
+      Out.u32(0);       // vda_next
+    };
+    verdef(VER_FLG_BASE, VER_NDX_GLOBAL, SoName, SoNameIdx, false);
+    for (size_t I = 0; I < VersionNames.size(); ++I) {
+      verdef(0, static_cast<uint16_t>(I + 2), VersionNames[I],
+             VersionNameIdx[I], I + 1 == VersionNames.size());
+    }
+  }
+
+  // The .text, .tdata, and .data placeholders are zero-filled.
+
+  // .dynamic
+  Out.padTo(Dynamic.Offset);
+  for (const auto& [Tag, Value] : dynamicEntries()) {
+    Out.word(static_cast<uint64_t>(Tag));
+    Out.word(Value);
+  }
+
+  // .shstrtab
+  Out.padTo(Sections[ShStrIdx].Offset);
+  Out.append(ShStr.data());
+
+  // Section headers
+  Out.padTo(ShOff + ShdrSize); // null section
+  for (uint32_t I = 1; I < Sections.size(); ++I) {
+    const SectionLayout& S = Sections[I];
+    Out.u32(ShStr.add(S.Name));
+    Out.u32(S.Type);
+    Out.word(S.Flags);
+    Out.word(S.Addr);
+    Out.word(S.Offset);
+    Out.word(S.Size);
+    Out.u32(S.Link);
+    Out.u32(S.Info);
+    Out.word(S.Align);
+    Out.word(S.EntSize);
+  }
+
+  return Out.bytes();
+}
+
+} // namespace
+
+bool writeDummySO(const gtirb::Module& Module, const std::string& Path,
+                  const std::string& SoName,
+                  const std::vector<SymbolGroup>& SymGroups,
+                  bool IgnoreSymbolVersions) {
+  std::optional<ElfTarget> Target = getElfTarget(Module);
+  if (!Target) {
+    LOG_ERROR << "Cannot write a dummy .so for the ISA of module "
+              << Module.getName() << "\n";
+    return false;
+  }
+
+  static const std::unordered_map<std::string, uint8_t> SymbolTypes = {
+      {"FUNC", STT_FUNC},     {"OBJECT", STT_OBJECT},
+      {"NOTYPE", STT_NOTYPE}, {"NONE", STT_NOTYPE},
+      {"TLS", STT_TLS},       {"GNU_IFUNC", STT_GNU_IFUNC},
+  };
+
+  DummySOBuilder Builder(*Target);
+  for (const auto& SymGroup : SymGroups) {
+    std::optional<uint64_t> SymSize;
+    std::vector<DummySymbol> GroupSymbols;
+
+    for (const gtirb::Symbol* Sym : SymGroup) {
+      auto SymInfo = aux_data::getElfSymbolInfo(*Sym);
+      if (!SymInfo) {
+        // See if we have a symbol for "foo_copy", if so use its info
+        // (see ElfBinaryPrinter::generateDummySO).
+        std::string CopyName = Sym->getName() + "_copy";
+        if (auto CopySymRange = Sym->getModule()->findSymbols(CopyName)) {
+          SymInfo = aux_data::getElfSymbolInfo(*(CopySymRange.begin()));
+        } else {
+          LOG_ERROR << "Symbol not in symbol table [" << Sym->getName()
+                    << "] while generating dummy SO\n";
+          return false;
+        }
+      }
+
+      if (!SymSize) {
+        SymSize = SymInfo->Size;
+      } else if (*SymSize != SymInfo->Size) {
+        LOG_ERROR << "Symbol group has mismatched sizes; " << Sym->getName()
+                  << " is " << SymInfo->Size << " bytes, but had " << *SymSize
+                  << " bytes\n";
+        return false;
+      }
+
+      const std::string& SymType = SymInfo->Type;
+      auto TypeIt = SymbolTypes.find(SymType);
+      if (TypeIt == SymbolTypes.end()) {
+        LOG_ERROR << "Unknown type: " << SymType
+                  << " for symbol: " << Sym->getName() << "\n";
+        return false;
+      }
+
+      Placeholder Section = Data;
+      if (SymType == "FUNC" || SymType == "GNU_IFUNC") {
+        Section = Text;
+      } else if (SymType == "TLS") {
+        Section = TData;
+      }
+
+      // A version string is "@@VERSION" for the default version of a symbol
+      // and "@VERSION" for a hidden one; an empty VERSION is the base version.
+      uint16_t Version = VER_NDX_GLOBAL;
+      if (!IgnoreSymbolVersions) {
+        if (auto VersionStr = aux_data::getSymbolVersionString(*Sym)) {
+          bool Hidden = VersionStr->compare(0, 2, "@@") != 0;
+          std::string VersionName = VersionStr->substr(Hidden ? 1 : 2);
+          if (!VersionName.empty()) {
+            Version = Builder.addVersion(VersionName);
+            if (Hidden) {
+              Version |= VERSYM_HIDDEN;
+            }
+          }
+        }
+      }
+
+      uint64_t Size =
+          (SymType == "OBJECT" || SymType == "TLS") ? SymInfo->Size : 0;
+      uint8_t Binding = SymInfo->Binding == "WEAK" ? STB_WEAK : STB_GLOBAL;
+      GroupSymbols.push_back(
+          {Sym->getName(), TypeIt->second, Binding, Section, 0, Size, Version});
+    }
+
+    if (GroupSymbols.empty()) {
+      continue;
+    }
+
+    // Only allocate space once for each symbol group, as symbol groups
+    // represent symbols that refer to the same data.
+    uint64_t Space = *SymSize;
+    if (Space == 0) {
+      Space = 4;
+    }
+    Placeholder Section = GroupSymbols.front().Section;
+    uint64_t Offset = Builder.allocate(Section, Space);
+    for (auto& Sym : GroupSymbols) {
+      Sym.Section = Section;
+      Sym.Offset = Offset;
+      Builder.addSymbol(std::move(Sym));
+    }
+  }
+
+  std::vector<uint8_t> Bytes = Builder.build(SoName);
+  std::ofstream Out(Path, std::ios::binary);
+  Out.write(reinterpret_cast<const char*>(Bytes.data()), Bytes.size());
+  if (!Out) {
+    LOG_ERROR << "Failed to write dummy .so: " << Path << "\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace gtirb_bprint
@@ -0,0 +1,206 @@
+//===- ElfEncoding.hpp ------------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Helpers shared by the writers that emit ELF files directly (dummy shared
+// objects and relocatable objects). This header is internal to the library.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ELF_ENCODING_H
+#define GTIRB_PP_ELF_ENCODING_H
+
+#include <gtirb/gtirb.hpp>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gtirb_bprint {
+namespace elf {
+
+// ELF constants. These are spelled out here rather than taken from <elf.h>,
+// which is not available on every host we build on.
+constexpr uint16_t ET_REL = 1;
+constexpr uint16_t ET_DYN = 3;
+
+constexpr uint16_t EM_386 = 3;
+constexpr uint16_t EM_MIPS = 8;
+constexpr uint16_t EM_ARM = 40;
+constexpr uint16_t EM_X86_64 = 62;
+constexpr uint16_t EM_AARCH64 = 183;
+
+constexpr uint32_t EF_ARM_EABI_VER5 = 0x05000000;
+constexpr uint32_t EF_MIPS_NOREORDER = 0x00000001;
+constexpr uint32_t EF_MIPS_PIC = 0x00000002;
+constexpr uint32_t EF_MIPS_CPIC = 0x00000004;
+constexpr uint32_t EF_MIPS_ABI_O32 = 0x00001000;
+constexpr uint32_t EF_MIPS_ARCH_32R2 = 0x70000000;
+
+constexpr uint32_t SHT_PROGBITS = 1;
+constexpr uint32_t SHT_SYMTAB = 2;
+constexpr uint32_t SHT_STRTAB = 3;
+constexpr uint32_t SHT_RELA = 4;
+constexpr uint32_t SHT_HASH = 5;
+constexpr uint32_t SHT_DYNAMIC = 6;
+constexpr uint32_t SHT_NOTE = 7;
+constexpr uint32_t SHT_NOBITS = 8;
+constexpr uint32_t SHT_DYNSYM = 11;
+constexpr uint32_t SHT_INIT_ARRAY = 14;
+constexpr uint32_t SHT_FINI_ARRAY = 15;
+constexpr uint32_t SHT_PREINIT_ARRAY = 16;
+constexpr uint32_t SHT_GNU_VERDEF = 0x6ffffffd;
+constexpr uint32_t SHT_GNU_VERSYM = 0x6fffffff;
+constexpr uint32_t SHT_X86_64_UNWIND = 0x70000001;
+
+constexpr uint64_t SHF_WRITE = 0x1;
+constexpr uint64_t SHF_ALLOC = 0x2;
+constexpr uint64_t SHF_EXECINSTR = 0x4;
+constexpr uint64_t SHF_INFO_LINK = 0x40;
+constexpr uint64_t SHF_TLS = 0x400;
+
+constexpr uint16_t SHN_UNDEF = 0;
+constexpr uint16_t SHN_LORESERVE = 0xff00;
+constexpr uint16_t SHN_ABS = 0xfff1;
+constexpr uint16_t SHN_COMMON = 0xfff2;
+
+constexpr uint8_t STB_LOCAL = 0;
+constexpr uint8_t STB_GLOBAL = 1;
+constexpr uint8_t STB_WEAK = 2;
+constexpr uint8_t STB_GNU_UNIQUE = 10;
+
+constexpr uint8_t STT_NOTYPE = 0;
+constexpr uint8_t STT_OBJECT = 1;
+constexpr uint8_t STT_FUNC = 2;
+constexpr uint8_t STT_SECTION = 3;
+constexpr uint8_t STT_TLS = 6;
+constexpr uint8_t STT_GNU_IFUNC = 10;
+
+constexpr uint8_t STV_DEFAULT = 0;
+constexpr uint8_t STV_INTERNAL = 1;
+constexpr uint8_t STV_HIDDEN = 2;
+constexpr uint8_t STV_PROTECTED = 3;
+
+struct ElfTarget {
+  bool Is64;
+  bool BigEndian;
+  uint16_t Machine;
+  uint32_t Flags;
+};
+
+inline std::optional<ElfTarget> getElfTarget(const gtirb::Module& Module) {
+  bool BigEndian = Module.getByteOrder() == gtirb::ByteOrder::Big;
+  switch (Module.getISA()) {
+  case gtirb::ISA::IA32:
+    return ElfTarget{false, false, EM_386, 0};
+  case gtirb::ISA::X64:
+    return ElfTarget{true, false, EM_X86_64, 0};
+  case gtirb::ISA::ARM:
+    return ElfTarget{false, false, EM_ARM, EF_ARM_EABI_VER5};
+  case gtirb::ISA::ARM64:
+    return ElfTarget{true, false, EM_AARCH64, 0};
+  case gtirb::ISA::MIPS32:
+    return ElfTarget{false, BigEndian, EM_MIPS,
+                     EF_MIPS_NOREORDER | EF_MIPS_PIC | EF_MIPS_CPIC |
+                         EF_MIPS_ABI_O32 | EF_MIPS_ARCH_32R2};
+  default:
+    return std::nullopt;
+  }
+}
+
+inline uint64_t alignTo(uint64_t Value, uint64_t Align) {
+  return (Value + Align - 1) / Align * Align;
+}
+
+/// Byte buffer that encodes integers with the target's width and byte order.
+class ElfBuffer {
+public:
+  explicit ElfBuffer(const ElfTarget& T) : Target(T) {}
+
+  void u8(uint8_t V) { Bytes.push_back(V); }
+  void u16(uint16_t V) { put(V, 2); }
+  void u32(uint32_t V) { put(V, 4); }
+  void u64(uint64_t V) { put(V, 8); }
+  void word(uint64_t V) { put(V, Target.Is64 ? 8 : 4); }
+  void uleb128(uint64_t V) {
+    do {
+      uint8_t Byte = V & 0x7f;
+      V >>= 7;
+      Bytes.push_back(V ? Byte | 0x80 : Byte);
+    } while (V);
+  }
+  void sleb128(int64_t V) {
+    bool More = true;
+    while (More) {
+      uint8_t Byte = V & 0x7f;
+      V >>= 7;
+      More = !((V == 0 && !(Byte & 0x40)) || (V == -1 && (Byte & 0x40)));
+      Bytes.push_back(More ? Byte | 0x80 : Byte);
+    }
+  }
+  void padTo(uint64_t Offset) { Bytes.resize(Offset, 0); }
+  void append(const std::string& S) {
+    Bytes.insert(Bytes.end(), S.begin(), S.end());
+  }
+  void append(const uint8_t* Data, uint64_t Size) {
+    Bytes.insert(Bytes.end(), Data, Data + Size);
+  }
+
+  /// Overwrite \p Size bytes at \p Offset with \p V.
+  void patch(uint64_t Offset, uint64_t V, int Size) {
+    for (int I = 0; I < Size; ++I) {
+      int Shift = Target.BigEndian ? (Size - 1 - I) * 8 : I * 8;
+      Bytes[Offset + I] = static_cast<uint8_t>(V >> Shift);
+    }
+  }
+
+  uint64_t size() const { return Bytes.size(); }
+  const std::vector<uint8_t>& bytes() const { return Bytes; }
+
+private:
+  void put(uint64_t V, int Size) {
+    Bytes.resize(Bytes.size() + Size);
+    patch(Bytes.size() - Size, V, Size);
+  }
+
+  ElfTarget Target;
+  std::vector<uint8_t> Bytes;
+};
+
+/// String table that shares the storage of repeated strings.
+class StringTable {
+public:
+  StringTable() : Data(1, '\0') {}
+
+  uint32_t add(const std::string& S) {
+    auto [It, Inserted] = Offsets.try_emplace(S, Data.size());
+    if (Inserted) {
+      Data += S;
+      Data.push_back('\0');
+    }
+    return It->second;
+  }
+
+  const std::string& data() const { return Data; }
+
+private:
+  std::string Data;
+  std::map<std::string, uint32_t> Offsets;
+};
+
+} // namespace elf
+} // namespace gtirb_bprint
+
+#endif /* GTIRB_PP_ELF_ENCODING_H */
@@ -0,0 +1,1521 @@
+//===- ElfObjectWriter.cpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+#include "ElfObjectWriter.hpp"
+
+#include "AuxDataUtils.hpp"
+#include "ElfEncoding.hpp"
+#include "driver/Logger.h"
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <unordered_map>
+
+namespace gtirb_pprint {
+
+namespace {
+
+using namespace gtirb_bprint::elf;
+
+// x86-64 relocation types.
+constexpr uint32_t R_X86_64_64 = 1;
+constexpr uint32_t R_X86_64_PC32 = 2;
+constexpr uint32_t R_X86_64_PLT32 = 4;
+constexpr uint32_t R_X86_64_GOTPCREL = 9;
+constexpr uint32_t R_X86_64_32 = 10;
+constexpr uint32_t R_X86_64_32S = 11;
+constexpr uint32_t R_X86_64_16 = 12;
+constexpr uint32_t R_X86_64_PC16 = 13;
+constexpr uint32_t R_X86_64_8 = 14;
+constexpr uint32_t R_X86_64_PC8 = 15;
+constexpr uint32_t R_X86_64_DTPOFF64 = 17;
+constexpr uint32_t R_X86_64_TPOFF64 = 18;
+constexpr uint32_t R_X86_64_TLSGD = 19;
+constexpr uint32_t R_X86_64_TLSLD = 20;
+constexpr uint32_t R_X86_64_DTPOFF32 = 21;
+constexpr uint32_t R_X86_64_GOTTPOFF = 22;
+constexpr uint32_t R_X86_64_TPOFF32 = 23;
+constexpr uint32_t R_X86_64_PC64 = 24;
+constexpr uint32_t R_X86_64_GOTOFF64 = 25;
+
+// DWARF call frame instructions and pointer encodings used in .eh_frame.
+constexpr uint8_t DW_CFA_advance_loc = 0x40;
+constexpr uint8_t DW_CFA_offset = 0x80;
+constexpr uint8_t DW_CFA_restore = 0xc0;
+constexpr uint8_t DW_CFA_nop = 0x00;
+constexpr uint8_t DW_CFA_advance_loc1 = 0x02;
+constexpr uint8_t DW_CFA_advance_loc2 = 0x03;
+constexpr uint8_t DW_CFA_advance_loc4 = 0x04;
+constexpr uint8_t DW_CFA_offset_extended = 0x05;
+constexpr uint8_t DW_CFA_restore_extended = 0x06;
+constexpr uint8_t DW_CFA_undefined = 0x07;
+constexpr uint8_t DW_CFA_same_value = 0x08;
+constexpr uint8_t DW_CFA_register = 0x09;
+constexpr uint8_t DW_CFA_remember_state = 0x0a;
+constexpr uint8_t DW_CFA_restore_state = 0x0b;
+constexpr uint8_t DW_CFA_def_cfa = 0x0c;
+constexpr uint8_t DW_CFA_def_cfa_register = 0x0d;
+constexpr uint8_t DW_CFA_def_cfa_offset = 0x0e;
+constexpr uint8_t DW_CFA_offset_extended_sf = 0x11;
+constexpr uint8_t DW_CFA_def_cfa_sf = 0x12;
+constexpr uint8_t DW_CFA_def_cfa_offset_sf = 0x13;
+constexpr uint8_t DW_CFA_val_offset = 0x14;
+constexpr uint8_t DW_CFA_val_offset_sf = 0x15;
+constexpr uint8_t DW_CFA_GNU_args_size = 0x2e;
+
+constexpr uint8_t DW_EH_PE_absptr = 0x00;
+constexpr uint8_t DW_EH_PE_pcrel = 0x10;
+constexpr uint8_t DW_EH_PE_indirect = 0x80;
+constexpr uint8_t DW_EH_PE_omit = 0xff;
+constexpr uint8_t DW_EH_PE_sdata4_pcrel = 0x1b;
+
+// The x86-64 psABI CIE: code alignment 1, data alignment -8, return address
+// in column 16, and the CFA at %rsp + 8 on entry.
+constexpr int64_t DataAlignment = -8;
+constexpr int64_t DefaultReturnColumn = 16;
+constexpr int64_t StackPointerColumn = 7;
+constexpr uint64_t EhFrameAlign = 8;
+
+// Recommended multi-byte NOPs, used to pad alignment in executable sections
+// the way the assembler does.
+const std::vector<std::vector<uint8_t>> NopSequences = {
+    {},
+    {0x90},
+    {0x66, 0x90},
+    {0x0f, 0x1f, 0x00},
+    {0x0f, 0x1f, 0x40, 0x00},
+    {0x0f, 0x1f, 0x44, 0x00, 0x00},
+    {0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00},
+    {0x0f, 0x1f, 0x80, 0x00, 0x00, 0x00, 0x00},
+    {0x0f, 0x1f, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+const ElfTarget X64Target{true, false, EM_X86_64, 0};
+
+const ElfSyntax& objectSyntax() {
+  static const ElfSyntax Syntax{};
+  return Syntax;
+}
+
+/// A symbol table entry is either one of the writer's symbols or the symbol
+/// of one of its sections.
+struct SymbolRef {
+  bool IsSection;
+  size_t Index;
+};
+
+struct Relocation {
+  uint64_t Offset;
+  uint32_t Type;
+  SymbolRef Target;
+  int64_t Addend;
+};
+
+struct ObjectSection {
+  std::string Name;
+  uint32_t Type;
+  uint64_t Flags;
+  uint64_t Align = 1;
+  uint64_t Size = 0;
+  ElfBuffer Contents{X64Target};
+  std::vector<Relocation> Relocations;
+
+  bool isNoBits() const { return Type == SHT_NOBITS; }
+};
+
+struct ObjectSymbol {
+  std::string Name;
+  uint8_t Binding = STB_LOCAL;
+  uint8_t Type = STT_NOTYPE;
+  uint8_t Visibility = STV_DEFAULT;
+  std::optional<size_t> Section;
+  uint16_t Shndx = SHN_UNDEF;
+  int64_t Value = 0;
+  uint64_t Size = 0;
+  // Set if a relocation needs the symbol itself rather than its section.
+  bool Referenced = false;
+
+  // Like the assembler, keep .L labels out of the symbol table.
+  bool isTemporary() const {
+    return Binding == STB_LOCAL && Section && Name.compare(0, 2, ".L") == 0;
+  }
+};
+
+/// A SymAddrConst, turned into a relocation once every symbol is known.
+struct SymbolFixup {
+  size_t Section;
+  uint64_t Offset;
+  uint32_t Type;
+  const gtirb::Symbol* Target;
+  int64_t Addend;
+};
+
+/// A SymAddrAddr, resolved to a constant if both symbols are in the same
+/// section, or to a PC-relative relocation if the subtrahend is in the section
+/// of the expression.
+struct DifferenceFixup {
+  size_t Section;
+  uint64_t Offset;
+  uint64_t Size;
+  std::string Encoding;
+  const gtirb::Symbol* Sym1;
+  const gtirb::Symbol* Sym2;
+  uint64_t Scale;
+  int64_t Addend;
+};
+
+/// Personality encoding and routine, LSDA encoding, return address column,
+/// and signal frame flag. FDEs that agree on these share a CIE.
+using CieKey =
+    std::tuple<uint8_t, const gtirb::Symbol*, uint8_t, int64_t, bool>;
+
+struct CfaState {
+  int64_t Register = StackPointerColumn;
+  int64_t Offset = -DataAlignment;
+};
+
+struct Fde {
+  size_t Section;
+  uint64_t Start;
+  uint64_t End = 0;
+  uint8_t PersonalityEncoding = DW_EH_PE_omit;
+  const gtirb::Symbol* Personality = nullptr;
+  uint8_t LsdaEncoding = DW_EH_PE_omit;
+  const gtirb::Symbol* Lsda = nullptr;
+  int64_t ReturnColumn = DefaultReturnColumn;
+  bool SignalFrame = false;
+  ElfBuffer Instructions{X64Target};
+  uint64_t Location;
+  CfaState Cfa;
+  std::vector<CfaState> SavedCfa;
+
+  CieKey cieKey() const {
+    return {PersonalityEncoding, Personality, LsdaEncoding, ReturnColumn,
+            SignalFrame};
+  }
+};
+
+bool hasAttributes(const gtirb::SymAttributeSet& Attrs,
+                   std::initializer_list<gtirb::SymAttribute> Expected) {
+  if (Attrs.size() != Expected.size()) {
+    return false;
+  }
+  return std::all_of(
+      Expected.begin(), Expected.end(),
+      [&Attrs](gtirb::SymAttribute A) { return Attrs.count(A); });
+}
+
+/// Relocation type for a symbolic operand of an instruction.
+std::optional<uint32_t> getCodeRelocationType(const gtirb::SymAttributeSet& A,
+                                              uint64_t Size, bool IsBranch,
+                                              bool IsPCRelative,
+                                              bool IsSigned) {
+  using gtirb::SymAttribute;
+  if (IsBranch) {
+    // Like the assembler, go through the PLT for every 32-bit branch; the
+    // linker resolves local targets directly.
+    if (Size == 4 && (A.size() == 0 || hasAttributes(A, {SymAttribute::PLT}))) {
+      return R_X86_64_PLT32;
+    }
+    if (Size == 1 && A.size() == 0) {
+      return R_X86_64_PC8;
+    }
+    return std::nullopt;
+  }
+  if (IsPCRelative) {
+    if (Size != 4) {
+      return std::nullopt;
+    }
+    if (A.size() == 0) {
+      return R_X86_64_PC32;
+    }
+    // The assembler honors an explicit @PLT on any PC-relative operand, e.g.
+    // `lea foo@PLT(%rip)`.
+    if (hasAttributes(A, {SymAttribute::PLT})) {
+      return R_X86_64_PLT32;
+    }
+    if (hasAttributes(A, {SymAttribute::GOT, SymAttribute::PCREL})) {
+      return R_X86_64_GOTPCREL;
+    }
+    if (hasAttributes(A, {SymAttribute::GOT, SymAttribute::TPOFF})) {
+      return R_X86_64_GOTTPOFF;
+    }
+    if (hasAttributes(A, {SymAttribute::TLSGD})) {
+      return R_X86_64_TLSGD;
+    }
+    if (hasAttributes(A, {SymAttribute::TLSLD})) {
+      return R_X86_64_TLSLD;
+    }
+    return std::nullopt;
+  }
+  switch (Size) {
+  case 8:
+    if (A.size() == 0) {
+      return R_X86_64_64;
+    }
+    if (hasAttributes(A, {SymAttribute::TPOFF})) {
+      return R_X86_64_TPOFF64;
+    }
+    if (hasAttributes(A, {SymAttribute::DTPOFF})) {
+      return R_X86_64_DTPOFF64;
+    }
+    if (hasAttributes(A, {SymAttribute::GOTOFF})) {
+      return R_X86_64_GOTOFF64;
+    }
+    return std::nullopt;
+  case 4:
+    if (A.size() == 0) {
+      return IsSigned ? R_X86_64_32S : R_X86_64_32;
+    }
+    if (hasAttributes(A, {SymAttribute::TPOFF})) {
+      return R_X86_64_TPOFF32;
+    }
+    if (hasAttributes(A, {SymAttribute::DTPOFF})) {
+      return R_X86_64_DTPOFF32;
+    }
+    return std::nullopt;
+  case 2:
+    return A.size() == 0 ? std::optional<uint32_t>(R_X86_64_16) : std::nullopt;
+  case 1:
+    return A.size() == 0 ? std::optional<uint32_t>(R_X86_64_8) : std::nullopt;
+  default:
+    return std::nullopt;
+  }
+}
+
+/// Relocation type for symbolic data. @PLT is only printed for branches, so
+/// it does not change the relocation of a data reference.
+std::optional<uint32_t> getDataRelocationType(gtirb::SymAttributeSet A,
+                                              uint64_t Size) {
+  A.erase(gtirb::SymAttribute::PLT);
+  return getCodeRelocationType(A, Size, false, false, false);
+}
+
+/// Relocation types that can refer to a section symbol in place of a local
+/// symbol in that section.
+bool isSectionRelative(uint32_t Type) {
+  switch (Type) {
+  case R_X86_64_64:
+  case R_X86_64_PC32:
+  case R_X86_64_32:
+  case R_X86_64_32S:
+  case R_X86_64_16:
+  case R_X86_64_PC16:
+  case R_X86_64_8:
+  case R_X86_64_PC8:
+  case R_X86_64_PC64:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// Size in bytes of the field a relocation of the given type applies to.
+int getRelocationSize(uint32_t Type) {
+  switch (Type) {
+  case R_X86_64_64:
+  case R_X86_64_DTPOFF64:
+  case R_X86_64_TPOFF64:
+  case R_X86_64_PC64:
+  case R_X86_64_GOTOFF64:
+    return 8;
+  case R_X86_64_16:
+  case R_X86_64_PC16:
+    return 2;
+  case R_X86_64_8:
+  case R_X86_64_PC8:
+    return 1;
+  default:
+    return 4;
+  }
+}
+
+/// Size in bytes of an .eh_frame pointer with the given encoding.
+std::optional<uint64_t> getPointerSize(uint8_t Encoding) {
+  switch (Encoding & 0x0f) {
+  case 0x00: // DW_EH_PE_absptr
+  case 0x04: // DW_EH_PE_udata8
+  case 0x0c: // DW_EH_PE_sdata8
+    return 8;
+  case 0x02: // DW_EH_PE_udata2
+  case 0x0a: // DW_EH_PE_sdata2
+    return 2;
+  case 0x03: // DW_EH_PE_udata4
+  case 0x0b: // DW_EH_PE_sdata4
+    return 4;
+  default:
+    return std::nullopt;
+  }
+}
+
+/// Relocation type for an .eh_frame pointer with the given encoding. Only
+/// absolute and PC-relative pointers are supported, as by the assembler.
+std::optional<uint32_t> getPointerRelocationType(uint8_t Encoding) {
+  auto Size = getPointerSize(Encoding);
+  uint8_t Application = Encoding & 0x70;
+  if (!Size || (Application != DW_EH_PE_absptr &&
+                Application != DW_EH_PE_pcrel)) {
+    return std::nullopt;
+  }
+  bool PCRel = Application == DW_EH_PE_pcrel;
+  switch (*Size) {
+  case 8:
+    return PCRel ? R_X86_64_PC64 : R_X86_64_64;
+  case 4:
+    return PCRel ? R_X86_64_PC32
+                 : ((Encoding & 0x08) ? R_X86_64_32S : R_X86_64_32);
+  default:
+    return PCRel ? R_X86_64_PC16 : R_X86_64_16;
+  }
+}
+
+void encodeAdvance(ElfBuffer& Out, uint64_t Delta) {
+  if (Delta == 0) {
+    return;
+  }
+  if (Delta < 0x40) {
+    Out.u8(DW_CFA_advance_loc | static_cast<uint8_t>(Delta));
+  } else if (Delta <= 0xff) {
+    Out.u8(DW_CFA_advance_loc1);
+    Out.u8(static_cast<uint8_t>(Delta));
+  } else if (Delta <= 0xffff) {
+    Out.u8(DW_CFA_advance_loc2);
+    Out.u16(static_cast<uint16_t>(Delta));
+  } else {
+    Out.u8(DW_CFA_advance_loc4);
+    Out.u32(static_cast<uint32_t>(Delta));
+  }
+}
+
+void encodeOffset(ElfBuffer& Out, int64_t Register, int64_t Offset,
+                  bool ValOffset) {
+  int64_t Factored = Offset / DataAlignment;
+  if (ValOffset) {
+    Out.u8(Factored < 0 ? DW_CFA_val_offset_sf : DW_CFA_val_offset);
+    Out.uleb128(Register);
+  } else if (Factored < 0) {
+    Out.u8(DW_CFA_offset_extended_sf);
+    Out.uleb128(Register);
+  } else if (Register < 0x40) {
+    Out.u8(DW_CFA_offset | static_cast<uint8_t>(Register));
+  } else {
+    Out.u8(DW_CFA_offset_extended);
+    Out.uleb128(Register);
+  }
+  if (Factored < 0) {
+    Out.sleb128(Factored);
+  } else {
+    Out.uleb128(Factored);
+  }
+}
+
+void encodeCfaOffset(ElfBuffer& Out, int64_t Offset) {
+  if (Offset < 0) {
+    Out.u8(DW_CFA_def_cfa_offset_sf);
+    Out.sleb128(Offset / DataAlignment);
+  } else {
+    Out.u8(DW_CFA_def_cfa_offset);
+    Out.uleb128(Offset);
+  }
+}
+
+/// Encode V in exactly Size bytes of LEB128, padding with continuation bytes
+/// as needed.
+std::optional<std::vector<uint8_t>> encodeFixedLeb128(int64_t V, uint64_t Size,
+                                                      bool Signed) {
+  ElfBuffer Buffer(X64Target);
+  if (Signed) {
+    Buffer.sleb128(V);
+  } else {
+    Buffer.uleb128(static_cast<uint64_t>(V));
+  }
+  std::vector<uint8_t> Bytes = Buffer.bytes();
+  if (Bytes.size() > Size) {
+    return std::nullopt;
+  }
+  uint8_t Fill = (Signed && V < 0) ? 0x7f : 0x00;
+  while (Bytes.size() < Size) {
+    Bytes.back() |= 0x80;
+    Bytes.push_back(Fill);
+  }
+  return Bytes;
+}
+
+std::optional<uint8_t> getSymbolType(const aux_data::ElfSymbolInfo& Info) {
+  static const std::unordered_map<std::string, uint8_t> SymbolTypes = {
+      {"FUNC", STT_FUNC},     {"OBJECT", STT_OBJECT},
+      {"NOTYPE", STT_NOTYPE}, {"NONE", STT_NOTYPE},
+      {"TLS", STT_TLS},       {"GNU_IFUNC", STT_GNU_IFUNC},
+  };
+  if (Info.Binding == "UNIQUE" || Info.Binding == "GNU_UNIQUE") {
+    return STT_OBJECT;
+  }
+  if (auto It = SymbolTypes.find(Info.Type); It != SymbolTypes.end()) {
+    return It->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<uint8_t> getSymbolBinding(const aux_data::ElfSymbolInfo& Info) {
+  static const std::unordered_map<std::string, uint8_t> SymbolBindings = {
+      {"LOCAL", STB_LOCAL},
+      {"GLOBAL", STB_GLOBAL},
+      {"WEAK", STB_WEAK},
+      {"UNIQUE", STB_GNU_UNIQUE},
+      {"GNU_UNIQUE", STB_GNU_UNIQUE},
+  };
+  if (auto It = SymbolBindings.find(Info.Binding);
+      It != SymbolBindings.end()) {
+    return It->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<uint8_t>
+getSymbolVisibility(const aux_data::ElfSymbolInfo& Info) {
+  static const std::unordered_map<std::string, uint8_t> SymbolVisibilities = {
+      {"DEFAULT", STV_DEFAULT},
+      {"HIDDEN", STV_HIDDEN},
+      {"PROTECTED", STV_PROTECTED},
+      {"INTERNAL", STV_INTERNAL},
+  };
+  if (auto It = SymbolVisibilities.find(Info.Visibility);
+      It != SymbolVisibilities.end()) {
+    return It->second;
+  }
+  return std::nullopt;
+}
+
+} // namespace
+
+struct ElfObjectWriter::ObjectState {
+  std::vector<ObjectSection> Sections;
+  std::map<std::string, size_t> SectionIndices;
+  std::optional<size_t> CurrentSection;
+
+  std::vector<ObjectSymbol> Symbols;
+  // Symbol table entries referenced by relocations against each symbol.
+  std::unordered_map<const gtirb::Symbol*, size_t> SymbolIndices;
+  std::map<std::string, size_t> UndefinedSymbols;
+
+  std::vector<SymbolFixup> SymbolFixups;
+  std::vector<DifferenceFixup> DifferenceFixups;
+
+  std::optional<Fde> CurrentFde;
+  std::vector<Fde> Fdes;
+
+  std::optional<std::string> Unsupported;
+
+  ObjectSection& section() { return Sections[*CurrentSection]; }
+  uint64_t position() { return section().Size; }
+
+  void appendZeros(uint64_t Size) {
+    ObjectSection& S = section();
+    S.Size += Size;
+    if (!S.isNoBits()) {
+      S.Contents.padTo(S.Size);
+    }
+  }
+
+  size_t addSymbol(ObjectSymbol Symbol) {
+    Symbols.push_back(std::move(Symbol));
+    return Symbols.size() - 1;
+  }
+};
+
+ElfObjectWriter::ElfObjectWriter(gtirb::Context& Context,
+                                 const gtirb::Module& Module,
+                                 const PrintingPolicy& Policy)
+    : AttPrettyPrinter(Context, Module, objectSyntax(), Policy),
+      State(std::make_unique<ObjectState>()) {}
+
+ElfObjectWriter::~ElfObjectWriter() = default;
+
+bool ElfObjectWriter::isSupported(const gtirb::Module& Module) {
+  return Module.getFileFormat() == gtirb::FileFormat::ELF &&
+         Module.getISA() == gtirb::ISA::X64;
+}
+
+void ElfObjectWriter::unsupported(const std::string& Reason) {
+  if (!State->Unsupported) {
+    State->Unsupported = Reason;
+  }
+}
+
+bool ElfObjectWriter::write(std::ostream& Stream) {
+  if (!isSupported(module)) {
+    LOG_WARNING << "Cannot write module " << module.getName()
+                << " directly: only x86-64 ELF modules are supported\n";
+    return false;
+  }
+
+  // Walk the module like the pretty printer does; the hooks below record the
+  // object file contents, so the text output itself is discarded.
+  std::ostream Discard(nullptr);
+  print(Discard);
+
+  std::vector<uint8_t> Bytes;
+  if (State->Unsupported || !build(Bytes)) {
+    LOG_WARNING << "Cannot write module " << module.getName()
+                << " directly: " << *State->Unsupported << "\n";
+    return false;
+  }
+  Stream.write(reinterpret_cast<const char*>(Bytes.data()), Bytes.size());
+  return static_cast<bool>(Stream);
+}
+
+const gtirb::Symbol*
+ElfObjectWriter::getReferenceTarget(const gtirb::Symbol* Symbol) const {
+  if (const gtirb::Symbol* Forwarded = getForwardedSymbol(Symbol)) {
+    if (policy.skipSymbols.count(getSymbolText(*Forwarded))) {
+      return nullptr;
+    }
+    return Forwarded;
+  }
+  if (shouldSkip(policy, *Symbol)) {
+    return nullptr;
+  }
+  return Symbol;
+}
+
+void ElfObjectWriter::printSectionHeader(std::ostream& /* OS */,
+                                         const gtirb::Section& Section) {
+  // Mirror the section directive: only the w, a, and x flags are printed,
+  // and the assembler infers everything else from the section name.
+  uint32_t Type = SHT_PROGBITS;
+  uint64_t Flags = 0;
+  if (auto Properties = aux_data::getSectionProperties(Section)) {
+    auto [PropertyType, PropertyFlags] = *Properties;
+    switch (PropertyType) {
+    case SHT_NOBITS:
+    case SHT_NOTE:
+    case SHT_INIT_ARRAY:
+    case SHT_FINI_ARRAY:
+    case SHT_PREINIT_ARRAY:
+      Type = static_cast<uint32_t>(PropertyType);
+      break;
+    default:
+      break;
+    }
+    Flags = PropertyFlags & (SHF_WRITE | SHF_ALLOC | SHF_EXECINSTR | SHF_TLS);
+  } else if (Section.getName() == ".text") {
+    Flags = SHF_ALLOC | SHF_EXECINSTR;
+  } else if (Section.getName() == ".data") {
+    Flags = SHF_ALLOC | SHF_WRITE;
+  } else if (Section.getName() == ".bss") {
+    Type = SHT_NOBITS;
+    Flags = SHF_ALLOC | SHF_WRITE;
+  }
+  if (Section.getName() == ".tdata" || Section.getName() == ".tbss") {
+    Flags |= SHF_TLS;
+  }
+
+  // Sections with the same name are merged, as by the assembler.
+  auto [It, Inserted] =
+      State->SectionIndices.try_emplace(Section.getName(),
+                                        State->Sections.size());
+  if (Inserted) {
+    ObjectSection S;
+    S.Name = Section.getName();
+    S.Type = Type;
+    S.Flags = Flags;
+    State->Sections.push_back(std::move(S));
+  }
+  State->CurrentSection = It->second;
+}
+
+void ElfObjectWriter::printSectionFooter(std::ostream& /* OS */,
+                                         const gtirb::Section& /* Section */) {
+  if (State->CurrentFde) {
+    unsupported("procedure without .cfi_endproc in section " +
+                State->section().Name);
+  }
+  State->CurrentSection.reset();
+}
+
+void ElfObjectWriter::printAlignment(std::ostream& /* OS */,
+                                     uint64_t Alignment) {
+  if (Alignment == 0) {
+    return;
+  }
+  ObjectSection& S = State->section();
+  S.Align = std::max(S.Align, Alignment);
+  uint64_t Padding = alignTo(S.Size, Alignment) - S.Size;
+  if (!(S.Flags & SHF_EXECINSTR) || S.isNoBits()) {
+    State->appendZeros(Padding);
+    return;
+  }
+  while (Padding > 0) {
+    uint64_t Size = std::min<uint64_t>(Padding, NopSequences.size() - 1);
+    const std::vector<uint8_t>& Nop = NopSequences[Size];
+    S.Contents.append(Nop.data(), Nop.size());
+    S.Size += Size;
+    Padding -= Size;
+  }
+}
+
+void ElfObjectWriter::appendBytes(const gtirb::ByteInterval& BI,
+                                  uint64_t Offset, uint64_t Size) {
+  ObjectSection& S = State->section();
+  uint64_t Initialized = std::min(
+      Size, BI.getInitializedSize() > Offset ? BI.getInitializedSize() - Offset
+                                             : 0);
+  if (S.isNoBits()) {
+    const uint8_t* Bytes = BI.rawBytes<uint8_t>() + Offset;
+    if (std::any_of(Bytes, Bytes + Initialized,
+                    [](uint8_t B) { return B != 0; })) {
+      unsupported("non-zero data in section " + S.Name);
+    }
+    S.Size += Size;
+    return;
+  }
+  S.Contents.append(BI.rawBytes<uint8_t>() + Offset, Initialized);
+  S.Size += Initialized;
+  State->appendZeros(Size - Initialized);
+}
+
+void ElfObjectWriter::printBlockContents(std::ostream& /* OS */,
+                                         const gtirb::CodeBlock& Block,
+                                         uint64_t Offset) {
+  if (Offset > Block.getSize() || State->Unsupported) {
+    return;
+  }
+  const gtirb::ByteInterval* BI = Block.getByteInterval();
+  // Position of the start of the block; an overlapping block starts before
+  // the current position.
+  uint64_t Start = State->position() - Offset;
+  appendBytes(*BI, Block.getOffset() + Offset, Block.getSize() - Offset);
+
+  cs_insn* Insn;
+  size_t Count = cs_disasm(this->csHandle, Block.rawBytes<uint8_t>() + Offset,
+                           Block.getSize() - Offset,
+                           static_cast<uint64_t>(*Block.getAddress()) + Offset,
+                           0, &Insn);
+
+  // Exception-safe cleanup of instructions
+  std::unique_ptr<cs_insn, std::function<void(cs_insn*)>> FreeInsn(
+      Insn, [Count](cs_insn* I) { cs_free(I, Count); });
+
+  uint64_t Displacement = Offset;
+  for (size_t I = 0; I < Count; I++) {
+    const cs_insn& Inst = Insn[I];
+    const cs_x86& Detail = Inst.detail->x86;
+    addCFIDirectives(gtirb::Offset(Block.getUUID(), Displacement),
+                     Start + Displacement);
+
+    uint64_t InstOffset = Block.getOffset() + Displacement;
+    bool IsBranch =
+        cs_insn_group(this->csHandle, &Inst, CS_GRP_BRANCH_RELATIVE);
+    std::optional<uint8_t> Handled;
+    for (uint8_t J = 0; J < Detail.op_count; ++J) {
+      const cs_x86_op& Op = Detail.operands[J];
+      uint8_t FieldOffset, FieldSize;
+      if (Op.type == X86_OP_IMM) {
+        FieldOffset = Detail.encoding.imm_offset;
+        FieldSize = Detail.encoding.imm_size;
+      } else if (Op.type == X86_OP_MEM) {
+        FieldOffset = Detail.encoding.disp_offset;
+        FieldSize = Detail.encoding.disp_size;
+      } else {
+        continue;
+      }
+      if (Handled == FieldOffset) {
+        continue;
+      }
+      Handled = FieldOffset;
+
+      const gtirb::SymbolicExpression* SymExpr =
+          BI->getSymbolicExpression(InstOffset + FieldOffset);
+      if (!SymExpr) {
+        continue;
+      }
+      if (FieldOffset == 0 || FieldSize == 0) {
+        // Older GTIRB puts the expression of moffset operands at the start
+        // of the instruction; only the assembler can place those.
+        unsupported("symbolic operand without an encoded field at " +
+                    std::to_string(Inst.address));
+        return;
+      }
+
+      bool IsPCRelative = IsBranch && Op.type == X86_OP_IMM;
+      bool IsSigned = false;
+      if (Op.type == X86_OP_MEM) {
+        IsPCRelative = Op.mem.base == X86_REG_RIP;
+        IsSigned = Detail.prefix[3] != X86_PREFIX_ADDRSIZE;
+      } else {
+        IsSigned = Op.size == 8;
+      }
+      std::optional<uint32_t> Type;
+      if (auto* SAC = std::get_if<gtirb::SymAddrConst>(SymExpr)) {
+        Type = getCodeRelocationType(SAC->Attributes, FieldSize,
+                                     IsBranch && Op.type == X86_OP_IMM,
+                                     IsPCRelative, IsSigned);
+      } else if (IsPCRelative) {
+        unsupported("PC-relative symbol difference at " +
+                    std::to_string(Inst.address));
+        return;
+      }
+      // PC-relative fields are relative to the end of the instruction.
+      int64_t PCBias =
+          IsPCRelative ? -static_cast<int64_t>(Inst.size - FieldOffset) : 0;
+      addSymbolicExpression(*SymExpr, Start + Displacement + FieldOffset,
+                            FieldSize, Type, PCBias, "");
+    }
+    Displacement += Inst.size;
+  }
+  // CFI directives located at the end of the block, e.g. '.cfi_endproc'.
+  addCFIDirectives(gtirb::Offset(Block.getUUID(), Displacement),
+                   Start + Displacement);
+}
+
+void ElfObjectWriter::printBlockContents(std::ostream& /* OS */,
+                                         const gtirb::DataBlock& Block,
+                                         uint64_t Offset) {
+  if (Offset > Block.getSize() || State->Unsupported) {
+    return;
+  }
+  const gtirb::ByteInterval* BI = Block.getByteInterval();
+  uint64_t Start = State->position() - Offset;
+  appendBytes(*BI, Block.getOffset() + Offset, Block.getSize() - Offset);
+
+  // Strings are printed as such, ignoring any symbolic expressions in them.
+  std::string Encoding = aux_data::getEncodingType(Block).value_or("");
+  if (Encoding == "string" || Encoding == "ascii") {
+    return;
+  }
+
+  uint64_t Next = Block.getOffset() + Offset;
+  uint64_t End = Block.getOffset() + Block.getSize();
+  for (const auto& SEE : BI->findSymbolicExpressionsAtOffset(Next, End)) {
+    if (SEE.getOffset() < Next) {
+      // The expression starts within the previous one.
+      continue;
+    }
+    uint64_t Size = getSymbolicExpressionSize(SEE);
+    if (Size == 0) {
+      unsupported("symbolic expression of unknown size in block at " +
+                  std::to_string(static_cast<uint64_t>(*Block.getAddress())));
+      return;
+    }
+    const gtirb::SymbolicExpression& SymExpr = SEE.getSymbolicExpression();
+    std::optional<uint32_t> Type;
+    if (auto* SAC = std::get_if<gtirb::SymAddrConst>(&SymExpr)) {
+      if (Encoding == "uleb128" || Encoding == "sleb128") {
+        unsupported("LEB128-encoded symbol address in block at " +
+                    std::to_string(static_cast<uint64_t>(*Block.getAddress())));
+        return;
+      }
+      Type = getDataRelocationType(SAC->Attributes, Size);
+    }
+    addSymbolicExpression(SymExpr,
+                          Start + (SEE.getOffset() - Block.getOffset()), Size,
+                          Type, 0, Encoding);
+    Next = SEE.getOffset() + Size;
+  }
+}
+
+void ElfObjectWriter::addSymbolicExpression(
+    const gtirb::SymbolicExpression& SymExpr, uint64_t Position, uint64_t Size,
+    std::optional<uint32_t> Type, int64_t PCBias, const std::string& Encoding) {
+  size_t Section = *State->CurrentSection;
+  ObjectSection& S = State->section();
+  if (Position + Size > S.Size) {
+    unsupported("symbolic expression past the end of a block in section " +
+                S.Name);
+    return;
+  }
+  // As with the assembler, the addend is kept in the relocation and the
+  // field itself is cleared.
+  if (!S.isNoBits()) {
+    S.Contents.patch(Position, 0, static_cast<int>(Size));
+  }
+
+  if (auto* SAC = std::get_if<gtirb::SymAddrConst>(&SymExpr)) {
+    const gtirb::Symbol* Target = getReferenceTarget(SAC->Sym);
+    if (!Target) {
+      // The pretty printer prints 0 for references to skipped symbols.
+      return;
+    }
+    if (!Type) {
+      std::stringstream Attrs;
+      for (const auto& Attr : SAC->Attributes) {
+        Attrs << ' ' << static_cast<uint16_t>(Attr);
+      }
+      unsupported("no " + std::to_string(Size) +
+                  "-byte relocation for reference to " + SAC->Sym->getName() +
+                  " with attributes" + Attrs.str());
+      return;
+    }
+    State->SymbolFixups.push_back(
+        {Section, Position, *Type, Target, SAC->Offset + PCBias});
+  } else if (auto* SAA = std::get_if<gtirb::SymAddrAddr>(&SymExpr)) {
+    const gtirb::Symbol* Sym1 = getReferenceTarget(SAA->Sym1);
+    const gtirb::Symbol* Sym2 = getReferenceTarget(SAA->Sym2);
+    if (!Sym1 || !Sym2 || SAA->Attributes.size() != 0 || SAA->Scale == 0) {
+      unsupported("unsupported symbol difference " + SAA->Sym1->getName() +
+                  " - " + SAA->Sym2->getName());
+      return;
+    }
+    State->DifferenceFixups.push_back({Section, Position, Size, Encoding, Sym1,
+                                       Sym2,
+                                       static_cast<uint64_t>(SAA->Scale),
+                                       SAA->Offset});
+  } else {
+    unsupported("unsupported symbolic expression in section " + S.Name);
+  }
+}
+
+void ElfObjectWriter::defineSymbol(const gtirb::Symbol& Symbol,
+                                   int64_t Position) {
+  ObjectSymbol Entry;
+  Entry.Name = getSymbolName(Symbol);
+  Entry.Section = State->CurrentSection;
+  Entry.Shndx = Entry.Section ? SHN_UNDEF : SHN_ABS;
+  Entry.Value = Position;
+
+  // Mirror printSymbolHeader: symbols without ELF symbol information, and
+  // FILE symbols, are plain local labels.
+  std::optional<std::string> Alias;
+  auto Info = aux_data::getElfSymbolInfo(Symbol);
+  if (Info && Info->Type != "FILE") {
+    auto Binding = getSymbolBinding(*Info);
+    auto Type = getSymbolType(*Info);
+    auto Visibility = getSymbolVisibility(*Info);
+    if (!Binding || !Type || !Visibility) {
+      unsupported("unknown binding, type, or visibility of symbol " +
+                  Symbol.getName());
+      return;
+    }
+    Entry.Binding = *Binding;
+    Entry.Type = *Type;
+    Entry.Visibility = *Visibility;
+    if (Info->Type == "OBJECT" || Info->Type == "TLS") {
+      Entry.Size = Info->Size;
+    }
+
+    if (auto Version = aux_data::getSymbolVersionString(Symbol)) {
+      if (policy.IgnoreSymbolVersions) {
+        LOG_WARNING << "Ignored symbol version for " << Entry.Name << *Version
+                    << "\n";
+      } else if (Entry.Name == Symbol.getName() &&
+                 Version->compare(0, 2, "@@") == 0) {
+        // Renamed rather than aliased (.symver with @@@).
+        Entry.Name = Symbol.getName() + *Version;
+      } else {
+        Alias = Symbol.getName() + *Version;
+      }
+    }
+  }
+
+  State->SymbolIndices[&Symbol] = State->addSymbol(Entry);
+  if (Alias) {
+    Entry.Name = *Alias;
+    State->addSymbol(Entry);
+  }
+}
+
+void ElfObjectWriter::printSymbolDefinition(std::ostream& /* OS */,
+                                            const gtirb::Symbol& Symbol) {
+  defineSymbol(Symbol, static_cast<int64_t>(State->position()));
+}
+
+void ElfObjectWriter::printSymbolDefinitionRelativeToPC(
+    std::ostream& /* OS */, const gtirb::Symbol& Symbol, gtirb::Addr PC) {
+  int64_t Delta = static_cast<int64_t>(static_cast<uint64_t>(
+                      *Symbol.getAddress())) -
+                  static_cast<int64_t>(static_cast<uint64_t>(PC));
+  defineSymbol(Symbol, static_cast<int64_t>(State->position()) + Delta);
+}
+
+void ElfObjectWriter::printFunctionEnd(std::ostream& /* OS */,
+                                       const gtirb::Symbol& FunctionSymbol) {
+  auto It = State->SymbolIndices.find(&FunctionSymbol);
+  if (It == State->SymbolIndices.end()) {
+    return;
+  }
+  ObjectSymbol& Entry = State->Symbols[It->second];
+  if (Entry.Section == State->CurrentSection) {
+    Entry.Size = State->position() - Entry.Value;
+  }
+}
+
+void ElfObjectWriter::printIntegralSymbol(std::ostream& /* OS */,
+                                          const gtirb::Symbol& Symbol) {
+  defineSymbol(Symbol, static_cast<int64_t>(
+                           static_cast<uint64_t>(*Symbol.getAddress())));
+}
+
+void ElfObjectWriter::printUndefinedSymbol(std::ostream& /* OS */,
+                                           const gtirb::Symbol& Symbol) {
+  auto Info = aux_data::getElfSymbolInfo(Symbol);
+  if (!Info) {
+    return;
+  }
+
+  ObjectSymbol Entry;
+  Entry.Name = Symbol.getName();
+  Entry.Binding = Info->Binding == "WEAK" ? STB_WEAK : STB_GLOBAL;
+  if (Info->SectionIndex == SHN_COMMON) {
+    // .comm IDENT,SIZE,ALIGN
+    uint64_t Align = aux_data::getAlignment(Symbol.getUUID(), module)
+                         .value_or(0);
+    if (Align == 0) {
+      Align = 1;
+      while (Align * 2 <= std::min<uint64_t>(Info->Size, 16)) {
+        Align *= 2;
+      }
+    }
+    Entry.Binding = STB_GLOBAL;
+    Entry.Type = STT_OBJECT;
+    Entry.Shndx = SHN_COMMON;
+    Entry.Value = static_cast<int64_t>(Align);
+    Entry.Size = Info->Size;
+  } else {
+    // Like printSymbolHeader, do not declare symbols with default attributes.
+    auto Version = aux_data::getSymbolVersionString(Symbol);
+    if ((Info->Binding == "LOCAL" && Info->Visibility == "DEFAULT" &&
+         (Info->Type == "NOTYPE" || Info->Type == "NONE") && !Version) ||
+        Info->Type == "FILE") {
+      return;
+    }
+    Entry.Name = getSymbolName(Symbol);
+    if (Version && !policy.IgnoreSymbolVersions) {
+      Entry.Name = Symbol.getName() + *Version;
+    }
+    auto Type = getSymbolType(*Info);
+    auto Visibility = getSymbolVisibility(*Info);
+    if (!Type || !Visibility) {
+      unsupported("unknown type or visibility of symbol " + Symbol.getName());
+      return;
+    }
+    Entry.Type = *Type;
+    Entry.Visibility = *Visibility;
+  }
+
+  auto [It, Inserted] = State->UndefinedSymbols.try_emplace(
+      Entry.Name, State->Symbols.size());
+  if (Inserted) {
+    State->addSymbol(Entry);
+  }
+  State->SymbolIndices.try_emplace(&Symbol, It->second);
+}
+
+void ElfObjectWriter::addCFIDirectives(const gtirb::Offset& Offset,
+                                       uint64_t Position) {
+  auto Directives = aux_data::getCFIDirectives(Offset, module);
+  if (!Directives) {
+    return;
+  }
+
+  std::optional<Fde>& Current = State->CurrentFde;
+  for (const auto& CfiDirective : *Directives) {
+    const std::string& Directive = CfiDirective.Directive;
+    const std::vector<int64_t>& Ops = CfiDirective.Operands;
+    auto operand = [&Ops](size_t I) { return I < Ops.size() ? Ops[I] : 0; };
+
+    if (Directive == ".cfi_startproc") {
+      Current.emplace();
+      Current->Section = *State->CurrentSection;
+      Current->Start = Position;
+      Current->Location = Position;
+      continue;
+    }
+    if (!Current) {
+      LOG_WARNING << "Missing `.cfi_startproc', omitting `" << Directive
+                  << "' directive.\n";
+      continue;
+    }
+    if (Directive == ".cfi_endproc") {
+      Current->End = Position;
+      State->Fdes.push_back(std::move(*Current));
+      Current.reset();
+      continue;
+    }
+
+    const gtirb::Symbol* Symbol = nullptr;
+    if (auto* Referenced =
+            nodeFromUUID<gtirb::Symbol>(context, CfiDirective.Uuid)) {
+      Symbol = getReferenceTarget(Referenced);
+      if (!Symbol) {
+        unsupported("CFI directive " + Directive +
+                    " refers to skipped symbol " + Referenced->getName());
+        return;
+      }
+    }
+
+    // Directives that describe the CIE or FDE rather than the instructions.
+    if (Directive == ".cfi_personality" || Directive == ".cfi_lsda") {
+      uint8_t Encoding = static_cast<uint8_t>(operand(0));
+      if (Encoding != DW_EH_PE_omit &&
+          (!Symbol || !getPointerRelocationType(Encoding &
+                                                ~DW_EH_PE_indirect))) {
+        unsupported(Directive + " with encoding " + std::to_string(Encoding));
+        return;
+      }
+      if (Directive == ".cfi_personality") {
+        Current->PersonalityEncoding = Encoding;
+        Current->Personality = Symbol;
+      } else {
+        Current->LsdaEncoding = Encoding;
+        Current->Lsda = Symbol;
+      }
+      continue;
+    }
+    if (Directive == ".cfi_return_column") {
+      Current->ReturnColumn = operand(0);
+      continue;
+    }
+    if (Directive == ".cfi_signal_frame") {
+      Current->SignalFrame = true;
+      continue;
+    }
+
+    ElfBuffer& Out = Current->Instructions;
+    CfaState& Cfa = Current->Cfa;
+    encodeAdvance(Out, Position - Current->Location);
+    Current->Location = Position;
+
+    if (Directive == ".cfi_def_cfa") {
+      Cfa = {operand(0), operand(1)};
+      if (Cfa.Offset < 0) {
+        Out.u8(DW_CFA_def_cfa_sf);
+        Out.uleb128(Cfa.Register);
+        Out.sleb128(Cfa.Offset / DataAlignment);
+      } else {
+        Out.u8(DW_CFA_def_cfa);
+        Out.uleb128(Cfa.Register);
+        Out.uleb128(Cfa.Offset);
+      }
+    } else if (Directive == ".cfi_def_cfa_register") {
+      Cfa.Register = operand(0);
+      Out.u8(DW_CFA_def_cfa_register);
+      Out.uleb128(Cfa.Register);
+    } else if (Directive == ".cfi_def_cfa_offset") {
+      Cfa.Offset = operand(0);
+      encodeCfaOffset(Out, Cfa.Offset);
+    } else if (Directive == ".cfi_adjust_cfa_offset") {
+      Cfa.Offset += operand(0);
+      encodeCfaOffset(Out, Cfa.Offset);
+    } else if (Directive == ".cfi_offset") {
+      encodeOffset(Out, operand(0), operand(1), false);
+    } else if (Directive == ".cfi_rel_offset") {
+      encodeOffset(Out, operand(0), operand(1) - Cfa.Offset, false);
+    } else if (Directive == ".cfi_val_offset") {
+      encodeOffset(Out, operand(0), operand(1), true);
+    } else if (Directive == ".cfi_restore") {
+      if (operand(0) < 0x40) {
+        Out.u8(DW_CFA_restore | static_cast<uint8_t>(operand(0)));
+      } else {
+        Out.u8(DW_CFA_restore_extended);
+        Out.uleb128(operand(0));
+      }
+    } else if (Directive == ".cfi_undefined") {
+      Out.u8(DW_CFA_undefined);
+      Out.uleb128(operand(0));
+    } else if (Directive == ".cfi_same_value") {
+      Out.u8(DW_CFA_same_value);
+      Out.uleb128(operand(0));
+    } else if (Directive == ".cfi_register") {
+      Out.u8(DW_CFA_register);
+      Out.uleb128(operand(0));
+      Out.uleb128(operand(1));
+    } else if (Directive == ".cfi_remember_state") {
+      Current->SavedCfa.push_back(Cfa);
+      Out.u8(DW_CFA_remember_state);
+    } else if (Directive == ".cfi_restore_state") {
+      if (!Current->SavedCfa.empty()) {
+        Cfa = Current->SavedCfa.back();
+        Current->SavedCfa.pop_back();
+      }
+      Out.u8(DW_CFA_restore_state);
+    } else if (Directive == ".cfi_gnu_args_size") {
+      Out.u8(DW_CFA_GNU_args_size);
+      Out.uleb128(operand(0));
+    } else if (Directive == ".cfi_escape") {
+      for (int64_t Byte : Ops) {
+        Out.u8(static_cast<uint8_t>(Byte));
+      }
+    } else {
+      unsupported("CFI directive " + Directive);
+      return;
+    }
+  }
+}
+
+bool ElfObjectWriter::build(std::vector<uint8_t>& Bytes) {
+  ObjectState& S = *State;
+
+  // Each gtirb symbol resolves to its definition, its declaration, or an
+  // undefined symbol named like the pretty printer would print it.
+  auto resolve = [&](const gtirb::Symbol* Symbol) {
+    if (auto It = S.SymbolIndices.find(Symbol); It != S.SymbolIndices.end()) {
+      return It->second;
+    }
+    ObjectSymbol Entry;
+    Entry.Name = getSymbolName(*Symbol);
+    Entry.Binding = STB_GLOBAL;
+    auto [It, Inserted] =
+        S.UndefinedSymbols.try_emplace(Entry.Name, S.Symbols.size());
+    if (Inserted) {
+      S.addSymbol(Entry);
+    }
+    S.SymbolIndices[Symbol] = It->second;
+    return It->second;
+  };
+  auto addRelocation = [&](size_t Section, uint64_t Offset, uint32_t Type,
+                           size_t Symbol, int64_t Addend) {
+    // The addend is in the relocation, so the field holds zero, as in the
+    // assembler's output.
+    if (!S.Sections[Section].isNoBits()) {
+      S.Sections[Section].Contents.patch(Offset, 0, getRelocationSize(Type));
+    }
+    ObjectSymbol& Target = S.Symbols[Symbol];
+    if (Target.isTemporary() &&
+        (isSectionRelative(Type) || Type == R_X86_64_PLT32)) {
+      // Refer to a local label through its section, as the assembler does.
+      if (Type == R_X86_64_PLT32) {
+        Type = R_X86_64_PC32;
+      }
+      S.Sections[Section].Relocations.push_back(
+          {Offset, Type, {true, *Target.Section}, Addend + Target.Value});
+    } else {
+      Target.Referenced = true;
+      S.Sections[Section].Relocations.push_back(
+          {Offset, Type, {false, Symbol}, Addend});
+    }
+  };
+
+  for (const SymbolFixup& F : S.SymbolFixups) {
+    addRelocation(F.Section, F.Offset, F.Type, resolve(F.Target), F.Addend);
+  }
+
+  for (const DifferenceFixup& F : S.DifferenceFixups) {
+    const ObjectSymbol& Sym1 = S.Symbols[resolve(F.Sym1)];
+    const ObjectSymbol& Sym2 = S.Symbols[resolve(F.Sym2)];
+    ObjectSection& Section = S.Sections[F.Section];
+    if (Sym1.Section && Sym1.Section == Sym2.Section) {
+      int64_t Value =
+          (Sym1.Value - Sym2.Value) / static_cast<int64_t>(F.Scale) + F.Addend;
+      if (Section.isNoBits()) {
+        continue;
+      }
+      if (F.Encoding == "uleb128" || F.Encoding == "sleb128") {
+        auto Leb = encodeFixedLeb128(Value, F.Size, F.Encoding == "sleb128");
+        if (!Leb) {
+          S.Unsupported = "LEB128 value " + std::to_string(Value) +
+                          " does not fit in " + std::to_string(F.Size) +
+                          " bytes";
+          return false;
+        }
+        for (uint64_t I = 0; I < F.Size; ++I) {
+          Section.Contents.patch(F.Offset + I, (*Leb)[I], 1);
+        }
+      } else {
+        Section.Contents.patch(F.Offset, static_cast<uint64_t>(Value),
+                               static_cast<int>(F.Size));
+      }
+    } else if (Sym2.Section == F.Section && F.Scale == 1 && F.Encoding == "" &&
+               (F.Size == 4 || F.Size == 8)) {
+      // Sym1 - Sym2 + A == Sym1 + (A + P - Sym2) - P
+      addRelocation(F.Section, F.Offset,
+                    F.Size == 4 ? R_X86_64_PC32 : R_X86_64_PC64,
+                    resolve(F.Sym1),
+                    F.Addend + static_cast<int64_t>(F.Offset) - Sym2.Value);
+    } else {
+      S.Unsupported = "symbol difference " + F.Sym1->getName() + " - " +
+                      F.Sym2->getName() + " across sections";
+      return false;
+    }
+  }
+
+  // .eh_frame: one CIE per distinct personality/LSDA configuration, followed
+  // by the FDEs that use it.
+  if (!S.Fdes.empty()) {
+    const size_t EhFrameIdx = S.Sections.size();
+    S.Sections.emplace_back();
+    ObjectSection& EhFrame = S.Sections.back();
+    EhFrame.Name = ".eh_frame";
+    EhFrame.Type = SHT_X86_64_UNWIND;
+    EhFrame.Flags = SHF_ALLOC;
+    EhFrame.Align = EhFrameAlign;
+    ElfBuffer& Out = EhFrame.Contents;
+
+    auto encodePointer = [&](uint8_t Encoding, const gtirb::Symbol* Symbol) {
+      uint8_t Plain = Encoding & ~DW_EH_PE_indirect;
+      uint64_t Size = *getPointerSize(Plain);
+      addRelocation(EhFrameIdx, Out.size(), *getPointerRelocationType(Plain),
+                    resolve(Symbol), 0);
+      Out.padTo(Out.size() + Size);
+    };
+    auto beginEntry = [&]() {
+      uint64_t Start = Out.size();
+      Out.u32(0); // length, patched by endEntry
+      return Start;
+    };
+    auto endEntry = [&](uint64_t Start) {
+      while (Out.size() % EhFrameAlign) {
+        Out.u8(DW_CFA_nop);
+      }
+      Out.patch(Start, Out.size() - Start - 4, 4);
+    };
+
+    std::map<CieKey, uint64_t> Cies;
+    for (const Fde& F : S.Fdes) {
+      auto [CieIt, NewCie] = Cies.try_emplace(F.cieKey(), Out.size());
+      if (NewCie) {
+        uint64_t Start = beginEntry();
+        Out.u32(0); // CIE id
+        Out.u8(1);  // version
+        std::string Augmentation = "z";
+        if (F.PersonalityEncoding != DW_EH_PE_omit) {
+          Augmentation += "P";
+        }
+        if (F.LsdaEncoding != DW_EH_PE_omit) {
+          Augmentation += "L";
+        }
+        Augmentation += "R";
+        if (F.SignalFrame) {
+          Augmentation += "S";
+        }
+        Out.append(Augmentation);
+        Out.u8(0);
+        Out.uleb128(1); // code alignment
+        Out.sleb128(DataAlignment);
+        Out.uleb128(F.ReturnColumn);
+
+        uint64_t AugmentationSize = 1;
+        if (F.PersonalityEncoding != DW_EH_PE_omit) {
+          AugmentationSize += 1 + *getPointerSize(F.PersonalityEncoding &
+                                                  ~DW_EH_PE_indirect);
+        }
+        if (F.LsdaEncoding != DW_EH_PE_omit) {
+          AugmentationSize += 1;
+        }
+        Out.uleb128(AugmentationSize);
+        if (F.PersonalityEncoding != DW_EH_PE_omit) {
+          Out.u8(F.PersonalityEncoding);
+          encodePointer(F.PersonalityEncoding, F.Personality);
+        }
+        if (F.LsdaEncoding != DW_EH_PE_omit) {
+          Out.u8(F.LsdaEncoding);
+        }
+        Out.u8(DW_EH_PE_sdata4_pcrel);
+
+        // Initial instructions: CFA = %rsp + 8, return address at CFA - 8.
+        Out.u8(DW_CFA_def_cfa);
+        Out.uleb128(StackPointerColumn);
+        Out.uleb128(-DataAlignment);
+        encodeOffset(Out, F.ReturnColumn, DataAlignment, false);
+        endEntry(Start);
+      }
+
+      uint64_t Start = beginEntry();
+      Out.u32(static_cast<uint32_t>(Out.size() - CieIt->second));
+      EhFrame.Relocations.push_back({Out.size(), R_X86_64_PC32,
+                                     {true, F.Section},
+                                     static_cast<int64_t>(F.Start)});
+      Out.u32(0);
+      Out.u32(static_cast<uint32_t>(F.End - F.Start));
+      if (F.LsdaEncoding != DW_EH_PE_omit) {
+        Out.uleb128(*getPointerSize(F.LsdaEncoding & ~DW_EH_PE_indirect));
+        encodePointer(F.LsdaEncoding, F.Lsda);
+      } else {
+        Out.uleb128(0);
+      }
+      Out.append(F.Instructions.bytes().data(), F.Instructions.size());
+      endEntry(Start);
+    }
+    EhFrame.Size = Out.size();
+  }
+
+  // Section header indices: content sections, their relocations, then the
+  // symbol and string tables.
+  const uint64_t EhdrSize = 64;
+  const uint64_t ShdrSize = 64;
+  const uint64_t SymSize = 24;
+  const uint64_t RelaSize = 24;
+  const size_t NumContent = S.Sections.size();
+  size_t NumRela = 0;
+  for (const auto& Section : S.Sections) {
+    NumRela += Section.Relocations.empty() ? 0 : 1;
+  }
+  const size_t SymTabIdx = 1 + NumContent + NumRela;
+  const size_t StrTabIdx = SymTabIdx + 1;
+  const size_t ShStrTabIdx = StrTabIdx + 1;
+  const size_t NumSections = ShStrTabIdx + 1;
+  if (NumSections >= SHN_LORESERVE) {
+    S.Unsupported = "too many sections";
+    return false;
+  }
+
+  // Symbol table: the null symbol, section symbols, locals, then globals.
+  StringTable StrTab;
+  std::vector<size_t> Order;
+  for (size_t I = 0; I < S.Symbols.size(); ++I) {
+    const ObjectSymbol& Sym = S.Symbols[I];
+    if (Sym.Binding == STB_LOCAL && !(Sym.isTemporary() && !Sym.Referenced)) {
+      Order.push_back(I);
+    }
+  }
+  const size_t FirstGlobal = 1 + NumContent + Order.size();
+  for (size_t I = 0; I < S.Symbols.size(); ++I) {
+    if (S.Symbols[I].Binding != STB_LOCAL) {
+      Order.push_back(I);
+    }
+  }
+  std::vector<uint32_t> FinalIndex(S.Symbols.size(), 0);
+  for (size_t I = 0; I < Order.size(); ++I) {
+    FinalIndex[Order[I]] = static_cast<uint32_t>(1 + NumContent + I);
+  }
+
+  ElfBuffer SymTab(X64Target);
+  SymTab.padTo(SymSize); // null symbol
+  auto symbolEntry = [&SymTab](uint32_t Name, uint8_t Info, uint8_t Other,
+                               uint16_t Shndx, uint64_t Value, uint64_t Size) {
+    SymTab.u32(Name);
+    SymTab.u8(Info);
+    SymTab.u8(Other);
+    SymTab.u16(Shndx);
+    SymTab.u64(Value);
+    SymTab.u64(Size);
+  };
+  for (size_t I = 0; I < NumContent; ++I) {
+    symbolEntry(0, (STB_LOCAL << 4) | STT_SECTION, 0,
+                static_cast<uint16_t>(1 + I), 0, 0);
+  }
+  for (size_t I : Order) {
+    const ObjectSymbol& Sym = S.Symbols[I];
+    uint16_t Shndx =
+        Sym.Section ? static_cast<uint16_t>(1 + *Sym.Section) : Sym.Shndx;
+    symbolEntry(StrTab.add(Sym.Name),
+                static_cast<uint8_t>((Sym.Binding << 4) | Sym.Type),
+                Sym.Visibility, Shndx, static_cast<uint64_t>(Sym.Value),
+                Sym.Size);
+  }
+
+  struct SectionHeader {
+    std::string Name;
+    uint32_t Type;
+    uint64_t Flags;
+    uint64_t Offset;
+    uint64_t Size;
+    uint32_t Link;
+    uint32_t Info;
+    uint64_t Align;
+    uint64_t EntSize;
+    const std::vector<uint8_t>* Data;
+  };
+  std::vector<SectionHeader> Headers;
+  std::vector<ElfBuffer> RelaData;
+  RelaData.reserve(NumRela);
+  for (const auto& Section : S.Sections) {
+    Headers.push_back({Section.Name, Section.Type, Section.Flags, 0,
+                       Section.Size, 0, 0, Section.Align, 0,
+                       Section.isNoBits() ? nullptr
+                                          : &Section.Contents.bytes()});
+  }
+  for (size_t I = 0; I < NumContent; ++I) {
+    const ObjectSection& Section = S.Sections[I];
+    if (Section.Relocations.empty()) {
+      continue;
+    }
+    ElfBuffer& Rela = RelaData.emplace_back(X64Target);
+    for (const Relocation& R : Section.Relocations) {
+      uint64_t Symbol = R.Target.IsSection ? 1 + R.Target.Index
+                                           : FinalIndex[R.Target.Index];
+      Rela.u64(R.Offset);
+      Rela.u64((Symbol << 32) | R.Type);
+      Rela.u64(static_cast<uint64_t>(R.Addend));
+    }
+    Headers.push_back({".rela" + Section.Name, SHT_RELA, SHF_INFO_LINK, 0,
+                       Rela.size(), static_cast<uint32_t>(SymTabIdx),
+                       static_cast<uint32_t>(1 + I), 8, RelaSize,
+                       &Rela.bytes()});
+  }
+  Headers.push_back({".symtab", SHT_SYMTAB, 0, 0, SymTab.size(),
+                     static_cast<uint32_t>(StrTabIdx),
+                     static_cast<uint32_t>(FirstGlobal), 8, SymSize,
+                     &SymTab.bytes()});
+  std::vector<uint8_t> StrTabData(StrTab.data().begin(), StrTab.data().end());
+  Headers.push_back({".strtab", SHT_STRTAB, 0, 0, StrTabData.size(), 0, 0, 1,
+                     0, &StrTabData});
+  StringTable ShStrTab;
+  for (const auto& Header : Headers) {
+    ShStrTab.add(Header.Name);
+  }
+  ShStrTab.add(".shstrtab");
+  std::vector<uint8_t> ShStrTabData(ShStrTab.data().begin(),
+                                    ShStrTab.data().end());
+  Headers.push_back({".shstrtab", SHT_STRTAB, 0, 0, ShStrTabData.size(), 0, 0,
+                     1, 0, &ShStrTabData});
+
+  uint64_t Offset = EhdrSize;
+  for (auto& Header : Headers) {
+    Offset = alignTo(Offset, std::max<uint64_t>(Header.Align, 1));
+    Header.Offset = Offset;
+    if (Header.Data) {
+      Offset += Header.Size;
+    }
+  }
+  const uint64_t ShOff = alignTo(Offset, 8);
+
+  ElfBuffer Out(X64Target);
+  Out.append("\x7f"
+             "ELF");
+  Out.u8(2);     // EI_CLASS: ELFCLASS64
+  Out.u8(1);     // EI_DATA: ELFDATA2LSB
+  Out.u8(1);     // EI_VERSION
+  Out.padTo(16); // EI_OSABI, EI_ABIVERSION, EI_PAD
+  Out.u16(ET_REL);
+  Out.u16(EM_X86_64);
+  Out.u32(1); // e_version
+  Out.u64(0); // e_entry
+  Out.u64(0); // e_phoff
+  Out.u64(ShOff);
+  Out.u32(0); // e_flags
+  Out.u16(static_cast<uint16_t>(EhdrSize));
+  Out.u16(0); // e_phentsize
+  Out.u16(0); // e_phnum
+  Out.u16(static_cast<uint16_t>(ShdrSize));
+  Out.u16(static_cast<uint16_t>(NumSections));
+  Out.u16(static_cast<uint16_t>(ShStrTabIdx));
+
+  for (const auto& Header : Headers) {
+    if (Header.Data) {
+      Out.padTo(Header.Offset);
+      Out.append(Header.Data->data(), Header.Data->size());
+    }
+  }
+
+  Out.padTo(ShOff + ShdrSize); // null section
+  for (const auto& Header : Headers) {
+    Out.u32(ShStrTab.add(Header.Name));
+    Out.u32(Header.Type);
+    Out.u64(Header.Flags);
+    Out.u64(0); // sh_addr
+    Out.u64(Header.Offset);
+    Out.u64(Header.Size);
+    Out.u32(Header.Link);
+    Out.u32(Header.Info);
+    Out.u64(Header.Align);
+    Out.u64(Header.EntSize);
+  }
+
+  Bytes = Out.bytes();
+  return true;
+}
+
+} // namespace gtirb_pprint
@@ -0,0 +1,104 @@
+//===- ElfObjectWriter.hpp --------------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// The object writer behind --object-direct. This header is internal to the
+// library.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_ELF_OBJECT_WRITER_H
+#define GTIRB_PP_ELF_OBJECT_WRITER_H
+
+#include "AttPrettyPrinter.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace gtirb_pprint {
+
+/// \brief Write an x86-64 ELF module directly as a relocatable object file.
+///
+/// The writer walks the module exactly as the AT&T pretty printer does, so the
+/// printing policy decides which sections, functions, and symbols are kept.
+/// Instead of printing text, each hook records what the assembler would have
+/// produced from it: block bytes are copied from their byte intervals,
+/// symbolic expressions become relocations, and CFI directives become
+/// `.eh_frame` entries.
+///
+/// Modules that use a construct the writer cannot encode are rejected; see
+/// \link write.
+class ElfObjectWriter : public AttPrettyPrinter {
+public:
+  ElfObjectWriter(gtirb::Context& Context, const gtirb::Module& Module,
+                  const PrintingPolicy& Policy);
+  ~ElfObjectWriter() override;
+
+  /// Return true if the writer supports the file format and ISA of Module.
+  static bool isSupported(const gtirb::Module& Module);
+
+  /// Write the object file to Stream.
+  ///
+  /// Returns false, after logging the reason, if the module contains a
+  /// symbolic expression, symbol attribute, or CFI directive that cannot be
+  /// encoded directly. Nothing is written in that case.
+  bool write(std::ostream& Stream);
+
+protected:
+  void printSectionHeader(std::ostream& OS,
+                          const gtirb::Section& Section) override;
+  void printSectionFooter(std::ostream& OS,
+                          const gtirb::Section& Section) override;
+  void printAlignment(std::ostream& OS, uint64_t Alignment) override;
+  void printBlockContents(std::ostream& OS, const gtirb::CodeBlock& Block,
+                          uint64_t Offset) override;
+  void printBlockContents(std::ostream& OS, const gtirb::DataBlock& Block,
+                          uint64_t Offset) override;
+  void printFunctionEnd(std::ostream& OS,
+                        const gtirb::Symbol& FunctionSymbol) override;
+  void printSymbolDefinition(std::ostream& OS,
+                             const gtirb::Symbol& Symbol) override;
+  void printSymbolDefinitionRelativeToPC(std::ostream& OS,
+                                         const gtirb::Symbol& Symbol,
+                                         gtirb::Addr PC) override;
+  void printIntegralSymbol(std::ostream& OS,
+                           const gtirb::Symbol& Symbol) override;
+  void printUndefinedSymbol(std::ostream& OS,
+                            const gtirb::Symbol& Symbol) override;
+
+private:
+  struct ObjectState;
+  std::unique_ptr<ObjectState> State;
+
+  /// Record the first reason the module cannot be written directly.
+  void unsupported(const std::string& Reason);
+
+  /// Return the symbol a reference to Symbol is emitted against, or nullptr
+  /// if the pretty printer would print 0 instead (see printSymbolReference).
+  const gtirb::Symbol* getReferenceTarget(const gtirb::Symbol* Symbol) const;
+
+  void defineSymbol(const gtirb::Symbol& Symbol, int64_t Position);
+  void addSymbolicExpression(const gtirb::SymbolicExpression& SymExpr,
+                             uint64_t Position, uint64_t Size,
+                             std::optional<uint32_t> Type, int64_t PCBias,
+                             const std::string& Encoding);
+  void addCFIDirectives(const gtirb::Offset& Offset, uint64_t Position);
+  void appendBytes(const gtirb::ByteInterval& BI, uint64_t Offset,
+                   uint64_t Size);
+  bool build(std::vector<uint8_t>& Bytes);
+};
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_ELF_OBJECT_WRITER_H */
@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 #include "ElfPrettyPrinter.hpp"
 #include "AuxDataUtils.hpp"
+#include "StringUtils.hpp"
 #include "driver/Logger.h"
 
 #include "AuxDataSchema.hpp"
@@ -147,8 +148,7 @@ void ElfPrettyPrinter::printInstruction(std::ostream& os,
 
     uint8_t dispOffset = inst.detail->x86.encoding.disp_offset;
     const gtirb::SymbolicExpression* symbolic =
-        block.getByteInterval()->getSymbolicExpression(
-            ea + dispOffset - *block.getByteInterval()->getAddress());
+        getSymbolicOperand(block, ea + dispOffset);
 
     if (symbolic) {
       if (const auto* expr = std::get_if<gtirb::SymAddrConst>(symbolic)) {
@@ -202,9 +202,8 @@ void ElfPrettyPrinter::printSectionFooterDirective(
 }
 
 void ElfPrettyPrinter::printByte(std::ostream& os, std::byte byte) {
-  std::ios_base::fmtflags flags = os.flags();
-  os << syntax.byteData() << " 0x" << std::hex << static_cast<uint32_t>(byte);
-  os.flags(flags);
+  os << syntax.byteData() << " 0x";
+  write_hex(os, static_cast<uint8_t>(byte));
 }
 
 void ElfPrettyPrinter::printFooter(std::ostream& /* os */){};
@@ -464,11 +463,16 @@ void ElfPrettyPrinter::printString(std::ostream& Stream,
                                    uint64_t Offset, bool NullTerminated) {
   Stream << (NullTerminated ? elfSyntax.string() : elfSyntax.ascii()) << " \"";
 
-  auto Bytes = Block.bytes<uint8_t>();
-  auto It = boost::make_iterator_range(Bytes.begin() + Offset, Bytes.end());
-  for (auto Byte : It) {
-    if (Byte != 0) {
-      Stream << syntax.escapeByte(Byte);
+  // Copy runs of bytes that need no escaping in one write. NUL bytes are
+  // dropped, so the uninitialized tail of the block, if any, prints nothing.
+  const uint8_t* Data = Block.rawBytes<uint8_t>();
+  uint64_t Size = getInitializedBlockSize(Block);
+  for (uint64_t I = Offset; I < Size; ++I) {
+    size_t Run = ascii_unescaped_prefix(Data + I, Size - I);
+    Stream.write(reinterpret_cast<const char*>(Data + I), Run);
+    I += Run;
+    if (I < Size && Data[I] != 0) {
+      Stream << syntax.escapeByte(Data[I]);
     }
   }
 
@@ -28,8 +28,13 @@
 #pragma warning(disable : 4456) // variable shadowing warning
 #endif                          // __GNUC__
 #include <boost/filesystem.hpp>
+#include <boost/process/child.hpp>
+#include <boost/process/io.hpp>
+#include <boost/process/pipe.hpp>
 #include <boost/process/search_path.hpp>
 #include <boost/process/system.hpp>
+#include <boost/uuid/name_generator_sha1.hpp>
+#include <boost/uuid/uuid_io.hpp>
 #include <iostream>
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
@@ -131,6 +136,21 @@ std::optional<int> execute(const std::string& Tool,
   return bp::system(Path, Args);
 }
 
+std::optional<int> execute(const std::string& Tool,
+                           const std::vector<std::string>& Args,
+                           std::string& Output) {
+  fs::path Path = fs::is_regular_file(Tool) ? Tool : bp::search_path(Tool);
+  if (Path.empty()) {
+    return std::nullopt;
+  }
+  bp::ipstream Stdout;
+  bp::child Child(Path, Args, bp::std_out > Stdout, bp::std_err > bp::null);
+  Output.assign(std::istreambuf_iterator<char>(Stdout),
+                std::istreambuf_iterator<char>());
+  Child.wait();
+  return Child.exit_code();
+}
+
 void copyFile(const std::string& src, const std::string& dest) {
   fs::path DestPath(dest);
   if (DestPath.has_parent_path()) {
@@ -147,4 +167,86 @@ void copyFile(const std::string& src, const std::string& dest) {
   fs::permissions(DestPath, perms);
 }
 
+FileCache::FileCache(const std::string& D) : Dir(D) {
+  boost::system::error_code ErrorCode;
+  fs::create_directories(Dir, ErrorCode);
+  if (ErrorCode.value()) {
+    LOG_WARNING << "Failed to create cache directory: " << Dir << "\n";
+  }
+}
+
+std::string FileCache::key(const std::vector<std::string>& Inputs) {
+  // Length-prefix each input so that different splits of the same bytes do
+  // not produce the same key.
+  std::string Data;
+  for (const auto& Input : Inputs) {
+    Data += std::to_string(Input.size());
+    Data += ':';
+    Data += Input;
+  }
+  boost::uuids::name_generator_sha1 Gen(boost::uuids::ns::oid());
+  return boost::uuids::to_string(Gen(Data));
+}
+
+std::optional<std::string> FileCache::fileKey(const std::string& Path) {
+  // Hash the file a chunk at a time, so that large files are never held in
+  // memory at once.
+  std::ifstream In(Path, std::ios::in | std::ios::binary);
+  if (!In) {
+    return std::nullopt;
+  }
+  std::vector<std::string> ChunkKeys;
+  std::string Chunk(1 << 24, '\0');
+  while (In) {
+    In.read(Chunk.data(), Chunk.size());
+    ChunkKeys.push_back(key({Chunk.substr(0, In.gcount())}));
+  }
+  if (In.bad()) {
+    return std::nullopt;
+  }
+  return key(ChunkKeys);
+}
+
+bool FileCache::fetch(const std::string& Key, const std::string& Dest,
+                      bool Link) const {
+  fs::path CachedPath = fs::path(Dir) / Key;
+  boost::system::error_code ErrorCode;
+  if (!fs::is_regular_file(CachedPath, ErrorCode)) {
+    return false;
+  }
+  fs::remove(Dest, ErrorCode);
+  if (Link) {
+    fs::create_hard_link(CachedPath, Dest, ErrorCode);
+  }
+  if (!Link || ErrorCode.value()) {
+    // Copy, as asked or because hard links do not work across file systems.
+#if BOOST_VERSION >= 107400
+    fs::copy_file(CachedPath, Dest, fs::copy_options::overwrite_existing,
+                  ErrorCode);
+#else
+    fs::copy_file(CachedPath, Dest, fs::copy_option::overwrite_if_exists,
+                  ErrorCode);
+#endif
+  }
+  return !ErrorCode.value();
+}
+
+void FileCache::store(const std::string& Key, const std::string& Src) const {
+  // Copy to a unique name first and then rename, so that concurrent writers
+  // never expose a partially written artifact.
+  fs::path CachedPath = fs::path(Dir) / Key;
+  fs::path TmpPath =
+      fs::path(Dir) / fs::unique_path(Key + ".%%%%-%%%%-%%%%.tmp");
+  boost::system::error_code ErrorCode;
+  fs::copy_file(Src, TmpPath, ErrorCode);
+  if (!ErrorCode.value()) {
+    fs::rename(TmpPath, CachedPath, ErrorCode);
+  }
+  if (ErrorCode.value()) {
+    LOG_WARNING << "Failed to store " << Src << " in cache: "
+                << ErrorCode.message() << "\n";
+    fs::remove(TmpPath, ErrorCode);
+  }
+}
+
 } // namespace gtirb_bprint
@@ -15,22 +15,47 @@
 
 #include "Fixup.hpp"
 #include "AuxDataUtils.hpp"
+#include "FileUtils.hpp"
+#include "Parallel.hpp"
 #include "PrettyPrinter.hpp"
 #include "driver/Logger.h"
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/uuid/string_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <fstream>
 #include <gtirb/gtirb.hpp>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace gtirb_pprint {
 
 void applyFixups(gtirb::Context& Context, gtirb::Module& Module,
                  const PrettyPrinter& Printer) {
+  applyFixups(Context, Module, Printer, "", "");
+}
+
+void applyFixups(gtirb::Context& Context, gtirb::Module& Module,
+                 const PrettyPrinter& Printer, const std::string& CacheDir,
+                 const std::string& Key) {
   auto format = std::get<0>(Printer.getTarget());
   if (format == "pe") {
     fixupPESymbols(Context, Module);
   }
   if (format == "elf") {
     fixupELFSymbols(Context, Module);
-    if (Printer.getDynMode(Module) == DYN_MODE_SHARED) {
-      fixupSharedObject(Context, Module);
+    DynMode Mode = Printer.getDynMode(Module);
+    if (Mode == DYN_MODE_SHARED) {
+      if (CacheDir.empty()) {
+        fixupSharedObject(Context, Module);
+      } else {
+        // The other fixups only look up a handful of symbols; only the
+        // shared-object fixup, which scans every code block, is cached.
+        fixupSharedObject(Context, Module, CacheDir,
+                          gtirb_bprint::FileCache::key(
+                              {Key, boost::uuids::to_string(Module.getUUID()),
+                               std::to_string(Mode)}));
+      }
     }
 
     if (Module.getISA() == gtirb::ISA::IA32) {
@@ -39,16 +64,62 @@ void applyFixups(gtirb::Context& Context, gtirb::Module& Module,
   }
 }
 
-void fixupSharedObject(gtirb::Context& Context, gtirb::Module& Module) {
-  std::unordered_set<gtirb::Symbol*> SymbolsToAlias;
-  std::vector<gtirb::ByteInterval::SymbolicExpressionElement> SEEsToAlias,
-      SEEsToPLT;
-  for (auto& CB : Module.code_blocks()) {
+namespace {
+
+// How a reference to a symbol must change in a shared object.
+enum class SharedReference { Allowed, HiddenAlias, PLT };
+
+// A symbolic expression that must be rewritten in a shared object.
+struct SharedObjectFixup {
+  uint64_t Offset;
+  // Refer to the hidden aliases of global symbols instead.
+  bool Alias;
+  // Go through the PLT.
+  bool PLT;
+};
+
+// The fixups found in one byte interval.
+struct IntervalFixups {
+  std::vector<SharedObjectFixup> Fixups;
+  std::vector<gtirb::Symbol*> SymbolsToAlias;
+};
+
+SharedReference classifySharedReference(const gtirb::Symbol& Symbol) {
+  if (!Symbol.hasReferent() && Symbol.getAddress()) {
+    return SharedReference::Allowed; // integral symbols don't need fixed up
+  }
+
+  if (auto Info = aux_data::getElfSymbolInfo(Symbol)) {
+    if (Info->Binding != "LOCAL" && Info->Visibility == "DEFAULT") {
+      // direct references to global symbols are not allowed in
+      // shared objects
+      if (!Symbol.hasReferent() || Symbol.getReferent<gtirb::ProxyBlock>() ||
+          aux_data::getForwardedSymbol(&Symbol)) {
+        if (Info->Type == "FUNC") {
+          // need to turn into a PLT reference
+          return SharedReference::PLT;
+        }
+      } else {
+        // need to change to the hidden alias
+        return SharedReference::HiddenAlias;
+      }
+    }
+  }
+  return SharedReference::Allowed;
+}
+
+// Find the symbolic expressions in the code blocks of an interval that must
+// be rewritten. Only reads the module.
+IntervalFixups findSharedObjectFixups(const gtirb::ByteInterval& BI) {
+  IntervalFixups Result;
+  std::unordered_map<const gtirb::Symbol*, SharedReference> Classes;
+  std::unordered_set<gtirb::Symbol*> Aliased;
+  for (const auto& CB : BI.code_blocks()) {
     // Previously, the changes here were not applied to any code blocks that
     // would be skipped by the PrettyPrinter. Now that these are being
     // separated, all code blocks are corrected and the printer can decide
     // whether to print them or not.
-    for (auto SEE : CB.getByteInterval()->findSymbolicExpressionsAtOffset(
+    for (const auto& SEE : BI.findSymbolicExpressionsAtOffset(
              CB.getOffset(), CB.getOffset() + CB.getSize())) {
       auto SymsToCheck = std::visit(
           [](const auto& SE) -> std::vector<gtirb::Symbol*> {
@@ -67,40 +138,95 @@ void fixupSharedObject(gtirb::Context& Context, gtirb::Module& Module) {
           },
           SEE.getSymbolicExpression());
 
+      SharedObjectFixup Fixup{SEE.getOffset(), false, false};
       for (auto* Symbol : SymsToCheck) {
-        if (!Symbol->hasReferent() && Symbol->getAddress()) {
-          continue; // integral symbols don't need fixed up
+        auto [It, Inserted] = Classes.try_emplace(Symbol);
+        if (Inserted) {
+          It->second = classifySharedReference(*Symbol);
         }
-
-        if (auto Info = aux_data::getElfSymbolInfo(*Symbol)) {
-          if (Info->Binding != "LOCAL" && Info->Visibility == "DEFAULT") {
-            // direct references to global symbols are not allowed in
-            // shared objects
-            if (!Symbol->hasReferent() ||
-                Symbol->getReferent<gtirb::ProxyBlock>() ||
-                aux_data::getForwardedSymbol(Symbol)) {
-              if (Info->Type == "FUNC") {
-                // need to turn into a PLT reference
-                SEEsToPLT.push_back(SEE);
-              }
-            } else {
-              // need to change to the hidden alias
-              SymbolsToAlias.insert(Symbol);
-              SEEsToAlias.push_back(SEE);
-            }
+        if (It->second == SharedReference::HiddenAlias) {
+          Fixup.Alias = true;
+          if (Aliased.insert(Symbol).second) {
+            Result.SymbolsToAlias.push_back(Symbol);
           }
+        } else if (It->second == SharedReference::PLT) {
+          Fixup.PLT = true;
         }
       }
+      if (Fixup.Alias || Fixup.PLT) {
+        Result.Fixups.push_back(Fixup);
+      }
+    }
+  }
+
+  // Overlapping code blocks may report an expression more than once.
+  std::stable_sort(Result.Fixups.begin(), Result.Fixups.end(),
+                   [](const auto& L, const auto& R) {
+                     return L.Offset < R.Offset;
+                   });
+  std::vector<SharedObjectFixup> Merged;
+  for (const SharedObjectFixup& Fixup : Result.Fixups) {
+    if (!Merged.empty() && Merged.back().Offset == Fixup.Offset) {
+      Merged.back().Alias |= Fixup.Alias;
+      Merged.back().PLT |= Fixup.PLT;
+    } else {
+      Merged.push_back(Fixup);
+    }
+  }
+  Result.Fixups = std::move(Merged);
+  return Result;
+}
+
+// The edits fixupSharedObject makes to a module.
+struct SharedObjectPatch {
+  std::vector<gtirb::Symbol*> SymbolsToAlias;
+  std::vector<std::pair<gtirb::ByteInterval*, std::vector<SharedObjectFixup>>>
+      Intervals;
+};
+
+// Find the edits needed to make a module acceptable in a shared object.
+SharedObjectPatch findSharedObjectPatch(gtirb::Module& Module) {
+  // Scanning the byte intervals only reads the module, so it is done in
+  // parallel; the changes are then applied serially. Reading AuxData may
+  // unpack it on first use, so do that before starting the workers.
+  Module.getAuxData<gtirb::schema::ElfSymbolInfo>();
+  Module.getAuxData<gtirb::schema::SymbolForwarding>();
+
+  std::vector<gtirb::ByteInterval*> Intervals;
+  for (auto& BI : Module.byte_intervals()) {
+    if (!BI.code_blocks().empty()) {
+      Intervals.push_back(&BI);
+    }
+  }
+  std::vector<IntervalFixups> Fixups(Intervals.size());
+  parallelFor(Intervals.size(), [&](size_t I) {
+    Fixups[I] = findSharedObjectFixups(*Intervals[I]);
+  });
+
+  SharedObjectPatch Patch;
+  std::unordered_set<gtirb::Symbol*> Aliased;
+  for (size_t I = 0; I < Intervals.size(); ++I) {
+    for (auto* Symbol : Fixups[I].SymbolsToAlias) {
+      if (Aliased.insert(Symbol).second) {
+        Patch.SymbolsToAlias.push_back(Symbol);
+      }
+    }
+    if (!Fixups[I].Fixups.empty()) {
+      Patch.Intervals.emplace_back(Intervals[I], std::move(Fixups[I].Fixups));
     }
   }
+  return Patch;
+}
 
+void applySharedObjectPatch(gtirb::Context& Context, gtirb::Module& Module,
+                            const SharedObjectPatch& Patch) {
   // make a hidden alias for every global symbol that is called
   // directly by a code block
   using GlobalToHiddenSymsType =
       std::unordered_map<gtirb::Symbol*, gtirb::Symbol*>;
   GlobalToHiddenSymsType GlobalToHiddenSyms;
 
-  for (auto* Symbol : SymbolsToAlias) {
+  for (auto* Symbol : Patch.SymbolsToAlias) {
     struct SetHiddenSymbolReferent {
       gtirb::Symbol* S;
       SetHiddenSymbolReferent(gtirb::Symbol* Sym) : S{Sym} {}
@@ -120,59 +246,173 @@ void fixupSharedObject(gtirb::Context& Context, gtirb::Module& Module) {
     GlobalToHiddenSyms[Symbol] = HiddenSymbol;
   }
 
-  // reassign bad code block references to hidden symbols
-  for (auto SEE : SEEsToAlias) {
-    auto SEToAdd = std::visit(
-        [&GlobalToHiddenSyms](const auto& SE) -> gtirb::SymbolicExpression {
-          using T = std::decay_t<decltype(SE)>;
-          T NewSE{SE};
-
-          if constexpr (std::is_same_v<T, gtirb::SymAddrAddr>) {
-            if (auto It = GlobalToHiddenSyms.find(SE.Sym1);
-                It != GlobalToHiddenSyms.end()) {
-              NewSE.Sym1 = It->second;
+  auto toHidden = [&GlobalToHiddenSyms](gtirb::Symbol* Sym) {
+    auto It = GlobalToHiddenSyms.find(Sym);
+    return It != GlobalToHiddenSyms.end() ? It->second : Sym;
+  };
+  auto toForwarded = [&Context](gtirb::Symbol* Sym) {
+    if (auto Target = aux_data::getForwardedSymbol(Sym)) {
+      return getByUUID<gtirb::Symbol>(Context, *Target);
+    }
+    return Sym;
+  };
+
+  // Apply the fixups one interval at a time, in offset order: reassign bad
+  // code block references to hidden symbols, and make bad code block
+  // references to extern symbols go through the PLT.
+  for (const auto& [BI, Fixups] : Patch.Intervals) {
+    for (const SharedObjectFixup& Fixup : Fixups) {
+      const gtirb::SymbolicExpression* SE =
+          BI->getSymbolicExpression(Fixup.Offset);
+      if (!SE) {
+        continue;
+      }
+      auto SEToAdd = std::visit(
+          [&](const auto& OldSE) -> gtirb::SymbolicExpression {
+            using T = std::decay_t<decltype(OldSE)>;
+            T NewSE{OldSE};
+
+            if (Fixup.PLT) {
+              NewSE.Attributes.insert(gtirb::SymAttribute::PLT);
             }
-            if (auto It = GlobalToHiddenSyms.find(SE.Sym2);
-                It != GlobalToHiddenSyms.end()) {
-              NewSE.Sym2 = It->second;
+            if constexpr (std::is_same_v<T, gtirb::SymAddrAddr>) {
+              if (Fixup.Alias) {
+                NewSE.Sym1 = toHidden(NewSE.Sym1);
+                NewSE.Sym2 = toHidden(NewSE.Sym2);
+              }
+              if (Fixup.PLT) {
+                NewSE.Sym1 = toForwarded(NewSE.Sym1);
+                NewSE.Sym2 = toForwarded(NewSE.Sym2);
+              }
+            } else if constexpr (std::is_same_v<T, gtirb::SymAddrConst>) {
+              if (Fixup.Alias) {
+                NewSE.Sym = toHidden(NewSE.Sym);
+              }
+              if (Fixup.PLT) {
+                NewSE.Sym = toForwarded(NewSE.Sym);
+              }
             }
-          } else if constexpr (std::is_same_v<T, gtirb::SymAddrConst>) {
-            NewSE.Sym = GlobalToHiddenSyms.at(SE.Sym);
-          }
 
-          return {NewSE};
-        },
-        SEE.getSymbolicExpression());
-    SEE.getByteInterval()->addSymbolicExpression(SEE.getOffset(), SEToAdd);
+            return {NewSE};
+          },
+          *SE);
+      BI->addSymbolicExpression(Fixup.Offset, SEToAdd);
+    }
+  }
+}
+
+// First line of a saved SharedObjectPatch; change it whenever the format or
+// the fixup itself changes, so that stale patches are not applied.
+const char* const SharedObjectPatchHeader = "gtirb-pprinter shared fixups 1";
+
+// Save a patch. Nodes are identified by UUID, so the patch can be applied to
+// the same module after it is loaded again.
+void writeSharedObjectPatch(std::ostream& Out, const SharedObjectPatch& Patch) {
+  Out << SharedObjectPatchHeader << "\n";
+  Out << Patch.SymbolsToAlias.size() << "\n";
+  for (const auto* Symbol : Patch.SymbolsToAlias) {
+    Out << boost::uuids::to_string(Symbol->getUUID()) << "\n";
+  }
+  Out << Patch.Intervals.size() << "\n";
+  for (const auto& [BI, Fixups] : Patch.Intervals) {
+    Out << boost::uuids::to_string(BI->getUUID()) << " " << Fixups.size()
+        << "\n";
+    for (const SharedObjectFixup& Fixup : Fixups) {
+      Out << Fixup.Offset << " " << Fixup.Alias << " " << Fixup.PLT << "\n";
+    }
   }
+}
 
-  // make bad code block references to extern symbols go through the PLT
-  for (auto SEE : SEEsToPLT) {
-    auto SEToAdd = std::visit(
-        [&Context](const auto& SE) -> gtirb::SymbolicExpression {
-          using T = std::decay_t<decltype(SE)>;
-          T NewSE{SE};
-          NewSE.Attributes.insert(gtirb::SymAttribute::PLT);
-
-          if constexpr (std::is_same_v<T, gtirb::SymAddrAddr>) {
-            if (auto Target = aux_data::getForwardedSymbol(SE.Sym1)) {
-              NewSE.Sym1 = getByUUID<gtirb::Symbol>(Context, *Target);
-            }
-            if (auto Target = aux_data::getForwardedSymbol(SE.Sym2)) {
-              NewSE.Sym2 = getByUUID<gtirb::Symbol>(Context, *Target);
-            }
-          } else if constexpr (std::is_same_v<T, gtirb::SymAddrConst>) {
-            if (auto Target = aux_data::getForwardedSymbol(SE.Sym)) {
-              NewSE.Sym = getByUUID<gtirb::Symbol>(Context, *Target);
-            }
-          }
+// Load a patch saved by writeSharedObjectPatch. Returns nullopt if it is
+// malformed or refers to nodes that do not exist.
+std::optional<SharedObjectPatch>
+readSharedObjectPatch(std::istream& In, gtirb::Context& Context) {
+  auto readUUID = [&In]() -> std::optional<gtirb::UUID> {
+    std::string Uuid;
+    if (!(In >> Uuid)) {
+      return std::nullopt;
+    }
+    try {
+      return boost::uuids::string_generator()(Uuid);
+    } catch (const std::runtime_error&) {
+      return std::nullopt;
+    }
+  };
 
-          return {NewSE};
-        },
-        SEE.getSymbolicExpression());
-    SEE.getByteInterval()->addSymbolicExpression(SEE.getOffset(), SEToAdd);
+  std::string Header;
+  if (!std::getline(In, Header) || Header != SharedObjectPatchHeader) {
+    return std::nullopt;
   }
-};
+  SharedObjectPatch Patch;
+  size_t Count = 0;
+  if (!(In >> Count)) {
+    return std::nullopt;
+  }
+  for (size_t I = 0; I < Count; ++I) {
+    auto Uuid = readUUID();
+    auto* Symbol = Uuid ? getByUUID<gtirb::Symbol>(Context, *Uuid) : nullptr;
+    if (!Symbol) {
+      return std::nullopt;
+    }
+    Patch.SymbolsToAlias.push_back(Symbol);
+  }
+  if (!(In >> Count)) {
+    return std::nullopt;
+  }
+  for (size_t I = 0; I < Count; ++I) {
+    auto Uuid = readUUID();
+    auto* BI = Uuid ? getByUUID<gtirb::ByteInterval>(Context, *Uuid) : nullptr;
+    size_t FixupCount = 0;
+    if (!BI || !(In >> FixupCount)) {
+      return std::nullopt;
+    }
+    std::vector<SharedObjectFixup> Fixups(FixupCount);
+    for (SharedObjectFixup& Fixup : Fixups) {
+      if (!(In >> Fixup.Offset >> Fixup.Alias >> Fixup.PLT)) {
+        return std::nullopt;
+      }
+    }
+    Patch.Intervals.emplace_back(BI, std::move(Fixups));
+  }
+  return Patch;
+}
+
+} // namespace
+
+void fixupSharedObject(gtirb::Context& Context, gtirb::Module& Module) {
+  applySharedObjectPatch(Context, Module, findSharedObjectPatch(Module));
+}
+
+void fixupSharedObject(gtirb::Context& Context, gtirb::Module& Module,
+                       const std::string& CacheDir, const std::string& Key) {
+  gtirb_bprint::FileCache Cache(CacheDir);
+  gtirb_bprint::TempFile PatchFile(".fixup");
+  PatchFile.close();
+
+  if (Cache.fetch(Key, PatchFile.fileName())) {
+    std::ifstream In(PatchFile.fileName());
+    if (auto Patch = readSharedObjectPatch(In, Context)) {
+      LOG_INFO << "Using cached shared-object fixups for module "
+               << Module.getName() << "\n";
+      applySharedObjectPatch(Context, Module, *Patch);
+      return;
+    }
+    LOG_WARNING << "Ignoring invalid cached fixups for module "
+                << Module.getName() << "\n";
+  }
+
+  SharedObjectPatch Patch = findSharedObjectPatch(Module);
+  {
+    // The fetched file is a hard link to the cached one; write a new file
+    // rather than rewriting the cache entry in place.
+    boost::system::error_code ErrorCode;
+    boost::filesystem::remove(PatchFile.fileName(), ErrorCode);
+    std::ofstream Out(PatchFile.fileName());
+    writeSharedObjectPatch(Out, Patch);
+  }
+  applySharedObjectPatch(Context, Module, Patch);
+  Cache.store(Key, PatchFile.fileName());
+}
 
 /**
 Update an ELF symbol's binding/visibility to GLOBAL/HIDDEN
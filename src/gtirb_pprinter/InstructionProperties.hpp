@@ -0,0 +1,115 @@
+//===- InstructionProperties.hpp --------------------------------*- C++ -*-===//
+//
+//  Copyright (C) 2023 GrammaTech, Inc.
+//
+//  This code is licensed under the MIT license. See the LICENSE file in the
+//  project root for license terms.
+//
+//  This project is sponsored by the Office of Naval Research, One Liberty
+//  Center, 875 N. Randolph Street, Arlington, VA 22203 under contract #
+//  N68335-17-C-0700.  The content of the information does not necessarily
+//  reflect the position or policy of the Government and no official
+//  endorsement should be inferred.
+//
+//===----------------------------------------------------------------------===//
+//
+// Printing properties of Capstone instructions, computed at compile time and
+// indexed by instruction id. This header is internal to the library.
+//
+//===----------------------------------------------------------------------===//
+#ifndef GTIRB_PP_INSTRUCTION_PROPERTIES_H
+#define GTIRB_PP_INSTRUCTION_PROPERTIES_H
+
+#include <capstone/capstone.h>
+#include <cstdint>
+#include <initializer_list>
+
+namespace gtirb_pprint {
+
+enum InstructionProperty : uint8_t {
+  // x86: mask (k) register operands are printed without braces.
+  UnbracketedMaskOperands = 1 << 0,
+  // x86: the first mask register is a destination and is not braced; only
+  // the following one is.
+  BracketedSecondMaskOperand = 1 << 1,
+  // ARM64: the condition code is printed as an implicit last operand.
+  ConditionCodeOperand = 1 << 2,
+};
+
+/// Property bits of every instruction id below Count.
+template <unsigned Count> class InstructionTable {
+public:
+  constexpr InstructionTable() : Properties{} {}
+
+  constexpr InstructionTable& set(uint8_t Property,
+                                  std::initializer_list<unsigned> Ids) {
+    for (unsigned Id : Ids)
+      Properties[Id] |= Property;
+    return *this;
+  }
+
+  constexpr bool has(unsigned Id, uint8_t Property) const {
+    return Id < Count && (Properties[Id] & Property) != 0;
+  }
+
+private:
+  uint8_t Properties[Count];
+};
+
+// To classify another instruction, add its id to the list of the property.
+
+// TODO: find an exhaustive list of the AVX512 instructions with unbracketed
+// mask operands, or find a way for Capstone to tell us this information
+// directly.
+inline constexpr auto X86Instructions =
+    InstructionTable<X86_INS_ENDING>()
+        .set(UnbracketedMaskOperands,
+             {
+                 X86_INS_KANDNB,   X86_INS_KANDNW,   X86_INS_KANDND,
+                 X86_INS_KANDNQ,   X86_INS_KMOVB,    X86_INS_KMOVW,
+                 X86_INS_KMOVD,    X86_INS_KMOVQ,    X86_INS_KUNPCKBW,
+                 X86_INS_KNOTB,    X86_INS_KNOTW,    X86_INS_KNOTD,
+                 X86_INS_KNOTQ,    X86_INS_KORB,     X86_INS_KORW,
+                 X86_INS_KORD,     X86_INS_KORQ,     X86_INS_KORTESTB,
+                 X86_INS_KORTESTW, X86_INS_KORTESTD, X86_INS_KORTESTQ,
+                 X86_INS_KSHIFTLB, X86_INS_KSHIFTLW, X86_INS_KSHIFTLD,
+                 X86_INS_KSHIFTLQ, X86_INS_KSHIFTRB, X86_INS_KSHIFTRW,
+                 X86_INS_KSHIFTRD, X86_INS_KSHIFTRQ, X86_INS_KXNORB,
+                 X86_INS_KXNORW,   X86_INS_KXNORD,   X86_INS_KXNORQ,
+                 X86_INS_KXORB,    X86_INS_KXORW,    X86_INS_KXORD,
+                 X86_INS_KXORQ,
+#if CS_API_MAJOR >= 5
+                 X86_INS_KUNPCKDQ, X86_INS_KUNPCKWD, X86_INS_KADDB,
+                 X86_INS_KADDW,    X86_INS_KADDD,    X86_INS_KADDQ,
+                 X86_INS_KTESTB,   X86_INS_KTESTW,   X86_INS_KTESTD,
+                 X86_INS_KTESTQ,   X86_INS_VPCMPESTRI,
+#endif
+             })
+        .set(BracketedSecondMaskOperand,
+             {
+                 X86_INS_VPCMPB,    X86_INS_VPCMPD,    X86_INS_VPCMPQ,
+                 X86_INS_VPCMPW,    X86_INS_VPCMPUB,   X86_INS_VPCMPUD,
+                 X86_INS_VPCMPUQ,   X86_INS_VPCMPUW,   X86_INS_VPCMPEQB,
+                 X86_INS_VPCMPEQD,  X86_INS_VPCMPEQQ,  X86_INS_VPCMPEQW,
+                 X86_INS_VPCMPGTB,  X86_INS_VPCMPGTD,  X86_INS_VPCMPGTQ,
+                 X86_INS_VPCMPGTW,  X86_INS_VPTEST,    X86_INS_VPTESTMB,
+                 X86_INS_VPTESTMD,  X86_INS_VPTESTMQ,  X86_INS_VPTESTMW,
+                 X86_INS_VPTESTNMB, X86_INS_VPTESTNMD, X86_INS_VPTESTNMQ,
+                 X86_INS_VPTESTNMW,
+             });
+
+// Capstone does not represent these conditions as explicit operands. See
+// https://github.com/capstone-engine/capstone/issues/1889
+inline constexpr auto Arm64Instructions =
+    InstructionTable<ARM64_INS_ENDING>().set(
+        ConditionCodeOperand,
+        {
+            ARM64_INS_CCMN,   ARM64_INS_CCMP,  ARM64_INS_CINC,  ARM64_INS_CINV,
+            ARM64_INS_CNEG,   ARM64_INS_CSEL,  ARM64_INS_CSET,  ARM64_INS_CSETM,
+            ARM64_INS_CSINC,  ARM64_INS_CSINV, ARM64_INS_CSNEG, ARM64_INS_FCCMP,
+            ARM64_INS_FCCMPE, ARM64_INS_FCSEL,
+        });
+
+} // namespace gtirb_pprint
+
+#endif /* GTIRB_PP_INSTRUCTION_PROPERTIES_H */
@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "IntelPrettyPrinter.hpp"
+#include "StringUtils.hpp"
 
 namespace gtirb_pprint {
 
@@ -76,7 +77,7 @@ void IntelPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
   const cs_x86_op& op = inst.detail->x86.operands[index];
   assert(op.type == X86_OP_REG &&
          "printOpRegdirect called without a register operand");
-  os << getRegisterName(op.reg);
+  os << getRegisterText(op.reg);
 }
 
 void IntelPrettyPrinter::printOpImmediate(
@@ -101,7 +102,7 @@ void IntelPrettyPrinter::printOpImmediate(
     PrettyPrinterBase::printSymbolicExpression(os, s, IsNotBranch);
   } else {
     // The operand is just a number.
-    os << op.imm;
+    write_dec(os, op.imm);
   }
 }
 
@@ -118,21 +119,21 @@ void IntelPrettyPrinter::printOpIndirect(
     os << *size << " PTR ";
 
   if (op.mem.segment != X86_REG_INVALID) {
-    os << getRegisterName(op.mem.segment) << ':';
+    os << getRegisterText(op.mem.segment) << ':';
   }
 
   os << '[';
 
   if (op.mem.base != X86_REG_INVALID) {
     first = false;
-    os << getRegisterName(op.mem.base);
+    os << getRegisterText(op.mem.base);
   }
 
   if (op.mem.index != X86_REG_INVALID) {
     if (!first)
       os << '+';
     first = false;
-    os << getRegisterName(op.mem.index) << '*' << std::to_string(op.mem.scale);
+    os << getRegisterText(op.mem.index) << '*' << std::to_string(op.mem.scale);
   }
 
   if (const auto* SAC = std::get_if<gtirb::SymAddrConst>(symbolic)) {
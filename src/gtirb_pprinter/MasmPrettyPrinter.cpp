@@ -20,6 +20,7 @@
 #include "FileUtils.hpp"
 #include "StringUtils.hpp"
 #include "regex"
+#include <algorithm>
 #include <boost/algorithm/string/replace.hpp>
 
 namespace gtirb_pprint {
@@ -641,8 +642,9 @@ void MasmPrettyPrinter::printIntegralSymbol(std::ostream& os,
   if (*symbol.getAddress() == gtirb::Addr(0)) {
     return;
   }
-  os << getSymbolName(symbol) << " = " << std::hex
-     << static_cast<uint64_t>(*symbol.getAddress()) << "H\n";
+  os << getSymbolName(symbol) << " = ";
+  write_hex(os, static_cast<uint64_t>(*symbol.getAddress()));
+  os << "H\n";
 }
 
 void MasmPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
@@ -650,7 +652,7 @@ void MasmPrettyPrinter::printOpRegdirect(std::ostream& os, const cs_insn& inst,
   const cs_x86_op& op = inst.detail->x86.operands[index];
   assert(op.type == X86_OP_REG &&
          "printOpRegdirect called without a register operand");
-  os << getRegisterName(op.reg);
+  os << getRegisterText(op.reg);
 }
 
 void MasmPrettyPrinter::printOpImmediate(
@@ -696,7 +698,7 @@ void MasmPrettyPrinter::printOpImmediate(
     printSymbolicExpression(os, s, !is_call && !is_jump);
   } else {
     // The operand is just a number.
-    os << op.imm;
+    write_dec(os, op.imm);
   }
 }
 
@@ -714,7 +716,8 @@ void MasmPrettyPrinter::printOpIndirect(
   // i.e.
   // "__imp_foo"
   if (const auto* s = std::get_if<gtirb::SymAddrConst>(symbolic)) {
-    std::optional<std::string> forwardedName = getForwardedSymbolName(s->Sym);
+    const std::optional<std::string>& forwardedName =
+        getForwardedSymbolText(s->Sym);
     if (forwardedName) {
       // If this references code, then it is (and should continue to) reference
       // the jmp thunk of the import which will have the unprefixed "foo" symbol
@@ -747,7 +750,7 @@ void MasmPrettyPrinter::printOpIndirect(
     os << *sizeName << " PTR ";
 
   if (op.mem.segment != X86_REG_INVALID)
-    os << getRegisterName(op.mem.segment) << ':';
+    os << getRegisterText(op.mem.segment) << ':';
 
   // MASM (x86) requires explicit DS: segment prefix for absolute, integral
   // addresses, otherwise the operand will be assembled as an immediate value
@@ -774,14 +777,14 @@ void MasmPrettyPrinter::printOpIndirect(
 
   if (op.mem.base != X86_REG_INVALID && op.mem.base != X86_REG_RIP) {
     first = false;
-    os << getRegisterName(op.mem.base);
+    os << getRegisterText(op.mem.base);
   }
 
   if (op.mem.index != X86_REG_INVALID) {
     if (!first)
       os << '+';
     first = false;
-    os << getRegisterName(op.mem.index) << '*' << std::to_string(op.mem.scale);
+    os << getRegisterText(op.mem.index) << '*' << std::to_string(op.mem.scale);
   }
 
   if (const auto* s = std::get_if<gtirb::SymAddrConst>(symbolic)) {
@@ -791,7 +794,7 @@ void MasmPrettyPrinter::printOpIndirect(
     printSymbolicExpression(os, s, false);
   } else if (const auto* rel = std::get_if<gtirb::SymAddrAddr>(symbolic)) {
     if (std::optional<gtirb::Addr> Addr = rel->Sym1->getAddress(); Addr) {
-      os << "+(" << masmSyntax.imagerel() << ' ' << getSymbolName(*rel->Sym1)
+      os << "+(" << masmSyntax.imagerel() << ' ' << getSymbolText(*rel->Sym1)
          << ")";
       printAddend(os, rel->Offset, false);
     }
@@ -820,21 +823,33 @@ void MasmPrettyPrinter::printSymbolicExpression(std::ostream& os,
 
 void MasmPrettyPrinter::printByte(std::ostream& os, std::byte byte) {
   // Byte constants must start with a number for the MASM assembler.
-  os << syntax.byteData() << " 0" << std::hex << std::setfill('0')
-     << std::setw(2) << static_cast<uint32_t>(byte) << 'H' << std::dec;
+  os << syntax.byteData() << " 0";
+  write_hex(os, static_cast<uint8_t>(byte), 2);
+  os << 'H';
+}
+
+void MasmPrettyPrinter::printByteRun(std::ostream& os, std::byte byte,
+                                     uint64_t Count) {
+  os << "DB ";
+  write_dec(os, Count);
+  os << " DUP(0";
+  write_hex(os, static_cast<uint8_t>(byte), 2);
+  os << "H)";
 }
 
 void MasmPrettyPrinter::printZeroDataBlock(std::ostream& os,
                                            const gtirb::DataBlock& dataObject,
                                            uint64_t offset) {
   os << syntax.tab();
-  os << "DB " << (dataObject.getSize() - offset) << " DUP(0)" << '\n';
+  os << "DB ";
+  write_dec(os, dataObject.getSize() - offset);
+  os << " DUP(0)" << '\n';
 }
 
 bool MasmPrettyPrinter::printSymbolReference(std::ostream& Stream,
                                              const gtirb::Symbol* Symbol) {
   if (Symbol && Symbol->getReferent<gtirb::DataBlock>()) {
-    if (std::optional<std::string> Name = getForwardedSymbolName(Symbol)) {
+    if (const auto& Name = getForwardedSymbolText(Symbol)) {
       Stream << "__imp_" << *Name;
       return true;
     }
@@ -848,9 +863,10 @@ void MasmPrettyPrinter::printString(std::ostream& Stream,
                                     uint64_t Offset, bool NullTerminated) {
   std::string Chunk{""};
 
-  auto Bytes = Block.bytes<uint8_t>();
-  auto It = boost::make_iterator_range(Bytes.begin() + Offset, Bytes.end());
-  for (uint8_t Byte : It) {
+  // Bytes past the initialized part of the block read as zero.
+  const uint8_t* Data = Block.rawBytes<uint8_t>();
+  uint64_t Initialized = getInitializedBlockSize(Block);
+  for (uint64_t I = Offset; I < Block.getSize(); ++I) {
     // NOTE: MASM only supports strings smaller than 256 bytes.
     //  and  MASM only supports statements with 50 comma-separated items.
     if (Chunk.size() >= 64) {
@@ -860,10 +876,16 @@ void MasmPrettyPrinter::printString(std::ostream& Stream,
     }
 
     // Aggegrate printable characters
-    if (std::isprint(Byte)) {
-      Chunk.append(1, Byte);
-      continue;
+    if (I < Initialized) {
+      size_t Run = ascii_printable_prefix(
+          Data + I, std::min<uint64_t>(Initialized - I, 64 - Chunk.size()));
+      if (Run > 0) {
+        Chunk.append(reinterpret_cast<const char*>(Data + I), Run);
+        I += Run - 1;
+        continue;
+      }
     }
+    uint8_t Byte = I < Initialized ? Data[I] : 0;
 
     // Found non-printable character, output previous chunk and print byte
     if (!Chunk.empty()) {
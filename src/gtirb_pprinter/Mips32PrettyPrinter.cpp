@@ -15,6 +15,7 @@
 
 #include "Mips32PrettyPrinter.hpp"
 #include "AuxDataSchema.hpp"
+#include "StringUtils.hpp"
 #include "driver/Logger.h"
 
 #include <capstone/capstone.h>
@@ -124,7 +125,7 @@ void Mips32PrettyPrinter::printOpRegdirect(std::ostream& os,
                                            uint64_t index) {
   const cs_mips_op& op = inst.detail->mips.operands[index];
   if (!printOpRegdirectSpecial(os, inst.id, index, op.reg))
-    os << getRegisterName(op.reg);
+    os << getRegisterText(op.reg);
 }
 
 void Mips32PrettyPrinter::printOpImmediate(
@@ -140,7 +141,7 @@ void Mips32PrettyPrinter::printOpImmediate(
     }
   } else {
     const cs_mips_op& op = inst.detail->mips.operands[index];
-    os << op.imm;
+    write_dec(os, op.imm);
   }
 }
 
@@ -158,10 +159,10 @@ void Mips32PrettyPrinter::printOpIndirect(
       assert(!"Unknown sym expr type in printOpImmediate!");
     }
   } else {
-    os << op.mem.disp;
+    write_dec(os, op.mem.disp);
   }
 
-  os << '(' << getRegisterName(op.mem.base) << ')';
+  os << '(' << getRegisterText(op.mem.base) << ')';
 }
 
 std::string Mips32PrettyPrinter::getRegisterName(unsigned int reg) const {
@@ -177,16 +178,14 @@ void Mips32PrettyPrinter::printOperand(std::ostream& os,
 
   switch (op.type) {
   case MIPS_OP_IMM:
-    SymExpr = block.getByteInterval()->getSymbolicExpression(
-        gtirb::Addr{inst.address} - *block.getByteInterval()->getAddress());
+    SymExpr = getSymbolicOperand(block, gtirb::Addr{inst.address});
     printOpImmediate(os, SymExpr, inst, index);
     return;
   case MIPS_OP_REG:
     printOpRegdirect(os, inst, index);
     return;
   case MIPS_OP_MEM:
-    SymExpr = block.getByteInterval()->getSymbolicExpression(
-        gtirb::Addr{inst.address} - *block.getByteInterval()->getAddress());
+    SymExpr = getSymbolicOperand(block, gtirb::Addr{inst.address});
     printOpIndirect(os, SymExpr, inst, index);
     return;
   default:
@@ -16,9 +16,13 @@
 #include "AuxDataSchema.hpp"
 #include "AuxDataUtils.hpp"
 #include "FileUtils.hpp"
+#include "Parallel.hpp"
 #include "driver/Logger.h"
 
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 
 #include <boost/filesystem.hpp>
 #include <boost/process/io.hpp>
@@ -68,6 +72,14 @@ struct PeLinkOptions {
 using CommandList =
     std::vector<std::pair<std::string, std::vector<std::string>>>;
 
+// A step of a build: its commands run in sequence once every step it depends
+// on has completed. Steps may only depend on steps added before them.
+struct CommandStep {
+  CommandList Commands;
+  std::vector<size_t> Dependencies;
+};
+using CommandGraph = std::vector<CommandStep>;
+
 using PeLib = std::function<CommandList(const PeLibOptions&)>;
 using PeAssemble = std::function<CommandList(const PeAssembleOptions&)>;
 using PeLink = std::function<CommandList(const PeLinkOptions&)>;
@@ -139,6 +151,16 @@ inline void appendCommands(CommandList& T, CommandList& U) {
            std::make_move_iterator(U.end()));
 }
 
+// Add a step to Graph and return its index.
+inline size_t addStep(CommandGraph& Graph, CommandList Commands,
+                      std::vector<size_t> Dependencies = {}) {
+  Graph.push_back({std::move(Commands), std::move(Dependencies)});
+  return Graph.size() - 1;
+}
+
+// Serializes log messages of commands run concurrently.
+static std::mutex LogMutex;
+
 int executeCommands(const CommandList& Commands) {
   for (const auto& [Command, Args] : Commands) {
     {
@@ -147,22 +169,79 @@ int executeCommands(const CommandList& Commands) {
       for (const auto& Arg : Args) {
         Stream << " " << Arg;
       }
+      std::lock_guard<std::mutex> Lock(LogMutex);
       LOG_INFO << Stream.str() << "\n";
     }
 
     if (std::optional<int> Rc = execute(Command, Args)) {
       if (*Rc) {
+        std::lock_guard<std::mutex> Lock(LogMutex);
         LOG_ERROR << Command << ": non-zero exit code: " << *Rc << "\n";
         return -1;
       }
       continue;
     }
+    std::lock_guard<std::mutex> Lock(LogMutex);
     LOG_ERROR << Command << ": command not found\n";
     return -1;
   }
   return 0;
 }
 
+// An import library that was not found in the cache, to be stored under Key
+// once it is built.
+struct ImportLibMiss {
+  std::string Key;
+  std::string Lib;
+};
+
+// Add the step that builds the import library Lib from Def to Graph, unless an
+// identical library is found in Cache. The library is determined by the DEF
+// text, the target machine, and the library tool.
+std::optional<size_t>
+addImportLibStep(CommandGraph& Graph, const std::optional<FileCache>& Cache,
+                 const std::string& Def, const std::string& Lib,
+                 const std::optional<std::string>& Machine,
+                 std::vector<ImportLibMiss>& Misses) {
+  CommandList Commands = libCommands({Def, Lib, Machine});
+  if (!Cache) {
+    return addStep(Graph, std::move(Commands));
+  }
+
+  std::ifstream DefFile(Def);
+  std::stringstream DefText;
+  DefText << DefFile.rdbuf();
+  std::vector<std::string> KeyInputs{DefText.str(), Machine.value_or("")};
+  for (const auto& [Command, Args] : Commands) {
+    KeyInputs.push_back(Command);
+  }
+  std::string Key = FileCache::key(KeyInputs);
+
+  // Lib is left next to the output for the user, so copy it rather than
+  // sharing the cached file.
+  if (Cache->fetch(Key, Lib, false)) {
+    LOG_INFO << "Using cached import library " << Lib << "\n";
+    return std::nullopt;
+  }
+  Misses.push_back({Key, Lib});
+  return addStep(Graph, std::move(Commands));
+}
+
+// Run the steps of Graph, running independent steps concurrently. Stops
+// starting new steps once one fails.
+int executeCommandGraph(const CommandGraph& Graph) {
+  std::vector<std::vector<size_t>> Dependencies;
+  Dependencies.reserve(Graph.size());
+  for (const CommandStep& Step : Graph) {
+    Dependencies.push_back(Step.Dependencies);
+  }
+  bool Succeeded =
+      gtirb_pprint::parallelForGraph(Dependencies, [&Graph](size_t I) {
+        return executeCommands(Graph[I].Commands) == 0;
+      });
+  return Succeeded ? 0 : -1;
+}
+
 // lib.exe /DEF:X.def /OUT:X.lib
 // Input: DEF  Output: LIB
 CommandList msvcLib(const PeLibOptions& Options) {
@@ -617,8 +696,10 @@ bool isPeDll(const gtirb::Module& Module) {
 PeBinaryPrinter::PeBinaryPrinter(
     const gtirb_pprint::PrettyPrinter& Printer_,
     const std::vector<std::string>& ExtraCompileArgs_,
-    const std::vector<std::string>& LibraryPaths_)
-    : BinaryPrinter(Printer_, ExtraCompileArgs_, LibraryPaths_) {}
+    const std::vector<std::string>& LibraryPaths_,
+    const std::string& ImportLibCacheDir_)
+    : BinaryPrinter(Printer_, ExtraCompileArgs_, LibraryPaths_),
+      ImportLibCacheDir(ImportLibCacheDir_) {}
 
 int PeBinaryPrinter::assemble(const std::string& Path, gtirb::Context& Context,
                               gtirb::Module& Module) const {
@@ -686,8 +767,15 @@ int PeBinaryPrinter::link(const std::string& OutputFile,
   // Find the PE binary type.
   bool Dll = isPeDll(Module);
 
-  // Build the list of commands.
-  CommandList Commands;
+  // Build the graph of commands: the import and export libraries are
+  // independent of each other, and the link needs all of them.
+  CommandGraph Commands;
+  std::vector<size_t> LibSteps;
+  std::optional<FileCache> Cache;
+  if (!ImportLibCacheDir.empty()) {
+    Cache.emplace(ImportLibCacheDir);
+  }
+  std::vector<ImportLibMiss> Misses;
 
   std::optional<std::string> ExportsFile;
   if (ExportDef) {
@@ -699,9 +787,8 @@ int PeBinaryPrinter::link(const std::string& OutputFile,
     LibFile.close();
     ExportsFile =
         fs::path(LibFile.fileName()).replace_extension(".exp").string();
-    CommandList ExpLibCommand =
-        libCommands({*ExportDef, LibFile.fileName(), Machine});
-    appendCommands(Commands, ExpLibCommand);
+    LibSteps.push_back(addStep(
+        Commands, libCommands({*ExportDef, LibFile.fileName(), Machine})));
   }
 
   // Add commands to generate .LIB files from import .DEF files.
@@ -709,21 +796,27 @@ int PeBinaryPrinter::link(const std::string& OutputFile,
     std::string Def = Temp->fileName();
     std::string Lib = replaceExtension(Import, ".lib");
 
-    CommandList LibCommands = libCommands({Def, Lib, Machine});
-    appendCommands(Commands, LibCommands);
+    if (auto Step =
+            addImportLibStep(Commands, Cache, Def, Lib, Machine, Misses)) {
+      LibSteps.push_back(*Step);
+    }
   }
   std::vector<TempFile> Compilands;
   Compilands.emplace_back(std::move(Compiland));
   TempFile tempOutput(".bin");
   tempOutput.close();
   // Add assemble-link commands.
-  CommandList LinkCommands = linkCommands(
-      {tempOutput.fileName(), Compilands, Resources, ExportsFile, EntryPoint,
-       Subsystem, Machine, Dll, ExtraCompileArgs, LibraryPaths});
-  appendCommands(Commands, LinkCommands);
-  // Execute the assemble-link command list.
-  auto retc = executeCommands(Commands);
+  addStep(Commands,
+          linkCommands({tempOutput.fileName(), Compilands, Resources,
+                        ExportsFile, EntryPoint, Subsystem, Machine, Dll,
+                        ExtraCompileArgs, LibraryPaths}),
+          LibSteps);
+  // Execute the assemble-link command graph.
+  auto retc = executeCommandGraph(Commands);
   if (retc == 0) {
+    for (const ImportLibMiss& Miss : Misses) {
+      Cache->store(Miss.Key, Miss.Lib);
+    }
     copyFile(tempOutput.fileName(), OutputFile);
   }
   return retc;
@@ -740,19 +833,29 @@ int PeBinaryPrinter::libs(const gtirb::Module& Module) const {
   // Find the target platform.
   std::optional<std::string> Machine = getPeMachine(Module);
 
-  // Build the list of commands.
-  CommandList Commands;
+  // Build the graph of commands; the libraries are independent of each other.
+  CommandGraph Commands;
+  std::optional<FileCache> Cache;
+  if (!ImportLibCacheDir.empty()) {
+    Cache.emplace(ImportLibCacheDir);
+  }
+  std::vector<ImportLibMiss> Misses;
 
   // Add commands to generate .LIB files from import .DEF files.
   for (auto& [Import, Temp] : ImportDefs) {
     std::string Def = Temp->fileName();
     std::string Lib = replaceExtension(Import, ".lib");
 
-    CommandList LibCommands = libCommands({Def, Lib, Machine});
-    appendCommands(Commands, LibCommands);
+    addImportLibStep(Commands, Cache, Def, Lib, Machine, Misses);
   }
 
-  return executeCommands(Commands);
+  int Ret = executeCommandGraph(Commands);
+  if (Ret == 0) {
+    for (const ImportLibMiss& Miss : Misses) {
+      Cache->store(Miss.Key, Miss.Lib);
+    }
+  }
+  return Ret;
 }
 
 int PeBinaryPrinter::resources(const gtirb::Module& Module,
@@ -17,11 +17,15 @@
 #include "driver/Logger.h"
 
 #include "AuxDataSchema.hpp"
+#include "ElfObjectWriter.hpp"
+#include "InstructionProperties.hpp"
 #include "StringUtils.hpp"
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 #include <boost/range/algorithm/find_if.hpp>
 #include <boost/uuid/uuid_io.hpp>
 #include <capstone/capstone.h>
+#include <cctype>
 #include <fstream>
 #include <gtirb/gtirb.hpp>
 #include <iomanip>
@@ -248,12 +252,7 @@ PrettyPrinter::getPolicy(const gtirb::Module& Module) const {
                                  : *Factory.findNamedPolicy(PolicyName);
 }
 
-int PrettyPrinter::print(std::ostream& Stream, gtirb::Context& Context,
-                         const gtirb::Module& Module) const {
-  // Find pretty printer factory.
-  PrettyPrinterFactory& Factory = getFactory(Module);
-
-  // Configure printing policy.
+PrintingPolicy PrettyPrinter::resolvePolicy(const gtirb::Module& Module) const {
   PrintingPolicy policy(getPolicy(Module));
   policy.LstMode = LstMode;
   policy.IgnoreSymbolVersions = IgnoreSymbolVersions;
@@ -261,6 +260,16 @@ int PrettyPrinter::print(std::ostream& Stream, gtirb::Context& Context,
   SymbolPolicy.apply(policy.skipSymbols);
   SectionPolicy.apply(policy.skipSections);
   ArraySectionPolicy.apply(policy.arraySections);
+  return policy;
+}
+
+int PrettyPrinter::print(std::ostream& Stream, gtirb::Context& Context,
+                         const gtirb::Module& Module) const {
+  // Find pretty printer factory.
+  PrettyPrinterFactory& Factory = getFactory(Module);
+
+  // Configure printing policy.
+  PrintingPolicy policy = resolvePolicy(Module);
 
   // Create the pretty printer and print the IR.
   if (aux_data::validateAuxData(Module, m_format)) {
@@ -271,6 +280,16 @@ int PrettyPrinter::print(std::ostream& Stream, gtirb::Context& Context,
   return -1;
 }
 
+int PrettyPrinter::writeObject(std::ostream& Stream, gtirb::Context& Context,
+                               const gtirb::Module& Module) const {
+  if (!ElfObjectWriter::isSupported(Module) || LstMode != ListingAssembler ||
+      !aux_data::validateAuxData(Module, m_format)) {
+    return -1;
+  }
+  ElfObjectWriter Writer(Context, Module, resolvePolicy(Module));
+  return Writer.write(Stream) ? 0 : -1;
+}
+
 boost::iterator_range<NamedPolicyMap::const_iterator>
 PrettyPrinterFactory::namedPolicies() const {
   return boost::make_iterator_range(NamedPolicies.begin(), NamedPolicies.end());
@@ -315,13 +334,75 @@ PrettyPrinterBase::PrettyPrinterBase(gtirb::Context& context_,
       context(context_), module(module_),
       PreferredEOLCommentPos(64), type_printer{module_, context_} {
   computeFunctionInformation();
+  computeAuxDataTables();
 }
 
 PrettyPrinterBase::~PrettyPrinterBase() { cs_close(&this->csHandle); }
 
 __END_DEPRECATED_DECL__()
 
+void PrettyPrinterBase::computeAuxDataTables() {
+  if (const auto* Alignments =
+          module.getAuxData<gtirb::schema::Alignment>()) {
+    // An entry for a block takes precedence over one for its byte interval,
+    // which takes precedence over one for its section.
+    std::unordered_map<const gtirb::Node*, std::pair<int, uint64_t>> Ranked;
+    auto addBlock = [&Ranked](const gtirb::Node& Block, int Rank,
+                              uint64_t Align) {
+      auto [It, Inserted] = Ranked.try_emplace(&Block, Rank, Align);
+      if (!Inserted && It->second.first < Rank) {
+        It->second = {Rank, Align};
+      }
+    };
+    auto addFirstBlocks = [&addBlock](const gtirb::ByteInterval& BI, int Rank,
+                                      uint64_t Align) {
+      for (const auto& Block : BI.findCodeBlocksAtOffset(0)) {
+        addBlock(Block, Rank, Align);
+      }
+      for (const auto& Block : BI.findDataBlocksAtOffset(0)) {
+        addBlock(Block, Rank, Align);
+      }
+    };
+
+    for (const auto& [Uuid, Align] : *Alignments) {
+      if (const auto* CB = nodeFromUUID<gtirb::CodeBlock>(context, Uuid)) {
+        addBlock(*CB, 2, Align);
+      } else if (const auto* DB =
+                     nodeFromUUID<gtirb::DataBlock>(context, Uuid)) {
+        addBlock(*DB, 2, Align);
+      } else if (const auto* BI =
+                     nodeFromUUID<gtirb::ByteInterval>(context, Uuid)) {
+        addFirstBlocks(*BI, 1, Align);
+      } else if (const auto* S = nodeFromUUID<gtirb::Section>(context, Uuid);
+                 S && !S->byte_intervals().empty()) {
+        addFirstBlocks(S->byte_intervals().front(), 0, Align);
+      }
+    }
+    for (const auto& [Block, RankedAlign] : Ranked) {
+      BlockAlignments.emplace(Block, RankedAlign.second);
+    }
+  }
+
+  if (const auto* Sizes =
+          module.getAuxData<gtirb::schema::SymbolicExpressionSizes>()) {
+    // Entries are ordered by interval UUID and then by offset, so each
+    // interval's list is built already sorted.
+    const gtirb::ByteInterval* BI = nullptr;
+    std::optional<gtirb::UUID> BIUuid;
+    for (const auto& [Offset, Size] : *Sizes) {
+      if (Offset.ElementId != BIUuid) {
+        BIUuid = Offset.ElementId;
+        BI = nodeFromUUID<gtirb::ByteInterval>(context, BIUuid);
+      }
+      if (BI) {
+        SymExprSizes[BI].emplace_back(Offset.Displacement, Size);
+      }
+    }
+  }
+}
+
 void PrettyPrinterBase::computeFunctionInformation() {
+  std::map<gtirb::UUID, const gtirb::Symbol*> FunctionToSymbols;
   auto FunctionNameMap = aux_data::getFunctionNames(module);
   // Compute function names
   for (const auto& Pair : FunctionNameMap) {
@@ -335,17 +416,20 @@ void PrettyPrinterBase::computeFunctionInformation() {
     }
   }
 
-  // Compute the begin and end address of a block
-  auto getUUIDAddrRange = [&](gtirb::UUID Uuid) {
+  // Find a block by UUID and compute its begin and end address, if it has one.
+  auto getBlockAddrRange = [&](gtirb::UUID Uuid) {
+    const gtirb::Node* Block = nullptr;
     std::optional<gtirb::Addr> Addr;
     uint64_t Size{0};
     const auto* CodeBlock = nodeFromUUID<gtirb::CodeBlock>(context, Uuid);
     if (CodeBlock) {
+      Block = CodeBlock;
       Addr = CodeBlock->getAddress();
       Size = CodeBlock->getSize();
     } else {
       const auto* DataBlock = nodeFromUUID<gtirb::DataBlock>(context, Uuid);
       if (DataBlock) {
+        Block = DataBlock;
         Addr = DataBlock->getAddress();
         Size = DataBlock->getSize();
       }
@@ -354,19 +438,28 @@ void PrettyPrinterBase::computeFunctionInformation() {
     if (Addr) {
       AddrRange = {*Addr, *Addr + Size};
     }
-    return AddrRange;
+    return std::make_pair(Block, AddrRange);
   };
   // Compute function blocks, start, and ends
   for (auto const& Function : aux_data::getFunctionBlocks(module)) {
     if (Function.second.size() == 0) {
       continue;
     }
+    const gtirb::Symbol* FunctionSymbol = nullptr;
+    if (auto It = FunctionToSymbols.find(Function.first);
+        It != FunctionToSymbols.end()) {
+      FunctionSymbol = It->second;
+    }
+
     gtirb::Addr FirstAddr{std::numeric_limits<uint64_t>::max()}, LastBlockAddr,
         LastAddr{0};
-    gtirb::UUID FirstBlock, LastBlock;
+    const gtirb::Node *FirstBlock = nullptr, *LastBlock = nullptr;
     for (auto& BlockUuid : Function.second) {
-      BlockToFunction[BlockUuid] = Function.first;
-      auto BlockRange = getUUIDAddrRange(BlockUuid);
+      auto [Block, BlockRange] = getBlockAddrRange(BlockUuid);
+      if (Block) {
+        // Blocks without an address still belong to the function.
+        FunctionBlockInfos[Block].FunctionSymbol = FunctionSymbol;
+      }
       if (!BlockRange) {
         LOG_WARNING << "UUID " << boost::uuids::to_string(BlockUuid)
                     << " in functionBlocks table references non-existent "
@@ -376,16 +469,20 @@ void PrettyPrinterBase::computeFunctionInformation() {
       const auto& [Beg, End] = *BlockRange;
       if (Beg < FirstAddr) {
         FirstAddr = Beg;
-        FirstBlock = BlockUuid;
+        FirstBlock = Block;
       }
       if (End > LastAddr) {
         LastAddr = End;
         LastBlockAddr = Beg;
-        LastBlock = BlockUuid;
+        LastBlock = Block;
       }
     }
-    FunctionFirstBlocks.insert(FirstBlock);
-    FunctionLastBlocks.insert(LastBlock);
+    if (FirstBlock) {
+      FunctionBlockInfos[FirstBlock].First = true;
+    }
+    if (LastBlock) {
+      FunctionBlockInfos[LastBlock].Last = true;
+    }
 
     __BEGIN_DEPRECATED_DECL__()
     // These are deprecated
@@ -399,6 +496,9 @@ void PrettyPrinterBase::computeFunctionInformation() {
 void PrettyPrinterBase::computeAmbiguousSymbols() {
   // Collect all ambiguous symbols in the module and give them
   // unique names
+  AmbiguousSymbols.clear();
+  SymbolTexts.clear();
+  ForwardedSymbolTexts.clear();
   std::map<const std::string, std::multimap<gtirb::Addr, const gtirb::Symbol*>>
       SymbolsByNameAddr;
   for (auto& S : module.symbols()) {
@@ -439,7 +539,7 @@ void PrettyPrinterBase::computeAmbiguousSymbols() {
 
 bool PrettyPrinterBase::isFunctionEntry(gtirb::Addr Addr) const {
   for (auto& Block : module.findBlocksAt(Addr)) {
-    if (FunctionFirstBlocks.count(Block.getUUID()) > 0) {
+    if (isFirstBlockOfFunction(Block)) {
       return true;
     }
   }
@@ -448,7 +548,7 @@ bool PrettyPrinterBase::isFunctionEntry(gtirb::Addr Addr) const {
 
 bool PrettyPrinterBase::isFunctionLastBlock(gtirb::Addr Addr) const {
   for (auto& Block : module.findBlocksAt(Addr)) {
-    if (FunctionLastBlocks.count(Block.getUUID()) > 0) {
+    if (isLastBlockOfFunction(Block)) {
       return true;
     }
   }
@@ -507,10 +607,9 @@ void PrettyPrinterBase::printOverlapWarning(std::ostream& os,
             << "The --layout option to gtirb-pprinter can fix "
                "overlapping elements."
             << std::endl;
-  std::ios_base::fmtflags flags = os.flags();
-  os << syntax.comment() << " WARNING: found overlapping blocks at address "
-     << std::hex << static_cast<uint64_t>(addr) << '\n';
-  os.flags(flags);
+  os << syntax.comment() << " WARNING: found overlapping blocks at address ";
+  write_hex(os, static_cast<uint64_t>(addr));
+  os << '\n';
 }
 
 void PrettyPrinterBase::printBlockContents(std::ostream& os,
@@ -585,8 +684,8 @@ void PrettyPrinterBase::printBar(std::ostream& os, bool heavy) {
 std::string PrettyPrinterBase::getFunctionName(gtirb::Addr Addr) const {
 
   for (auto& Block : module.findBlocksAt(Addr)) {
-    if (FunctionFirstBlocks.count(Block.getUUID()) > 0) {
-      if (auto FunctionSymbol = getContainerFunctionSymbol(Block.getUUID());
+    if (isFirstBlockOfFunction(Block)) {
+      if (auto FunctionSymbol = getContainerFunctionSymbol(Block);
           FunctionSymbol) {
         return FunctionSymbol->getName();
       } else {
@@ -604,7 +703,8 @@ bool PrettyPrinterBase::printSymbolReference(std::ostream& os,
   if (!symbol)
     return false;
 
-  std::optional<std::string> forwardedName = getForwardedSymbolName(symbol);
+  const std::optional<std::string>& forwardedName =
+      getForwardedSymbolText(symbol);
   if (forwardedName) {
     if (LstMode == ListingDebug || LstMode == ListingUI) {
       os << forwardedName.value();
@@ -637,13 +737,13 @@ bool PrettyPrinterBase::printSymbolReference(std::ostream& os,
     }
     return true;
   }
-  os << getSymbolName(*symbol);
+  os << getSymbolText(*symbol);
   return false;
 }
 
 void PrettyPrinterBase::printSymbolDefinition(std::ostream& os,
                                               const gtirb::Symbol& symbol) {
-  os << getSymbolName(symbol) << ":\n";
+  os << getSymbolText(symbol) << ":\n";
 }
 
 void PrettyPrinterBase::fixupInstruction(cs_insn&) {}
@@ -734,7 +834,7 @@ void PrettyPrinterBase::printPrototype(std::ostream& os,
     return;
   }
   auto Addr = *block.getAddress() + offset.Displacement;
-  if (FunctionFirstBlocks.count(block.getUUID()) > 0 &&
+  if (isFirstBlockOfFunction(block) &&
       offset.Displacement == 0) {
     type_printer.printPrototype(Addr, os, syntax.comment()) << std::endl;
   }
@@ -769,9 +869,8 @@ void PrettyPrinterBase::printInstruction(std::ostream& os,
   ////////////////////////////////////////////////////////////////////
 
   std::stringstream InstructLine;
-  std::string opcode = ascii_str_tolower(inst.mnemonic);
   printEA(InstructLine, ea);
-  InstructLine << "  " << opcode << ' ';
+  InstructLine << "  " << getMnemonicText(inst) << ' ';
   // Make sure the initial m_accum_comment is empty.
   m_accum_comment.clear();
   printOperandList(InstructLine, block, inst);
@@ -786,7 +885,8 @@ void PrettyPrinterBase::printInstruction(std::ostream& os,
 void PrettyPrinterBase::printEA(std::ostream& os, gtirb::Addr ea) {
   os << syntax.tab();
   if (this->LstMode == ListingDebug) {
-    os << std::hex << static_cast<uint64_t>(ea) << ": " << std::dec;
+    write_hex(os, static_cast<uint64_t>(ea));
+    os << ": ";
   }
 }
 
@@ -799,45 +899,14 @@ void PrettyPrinterBase::printOperandList(std::ostream& os,
   // put it in between {}s. These instructions are always AVX512 instructions
   // when you use the k registers. Not all AVX512 instructions use the k
   // registers in this manner, however.
-  // TODO: find an exhaustive list of such instructions, or find a way for
-  // Capstone to tell us this information directly.
-  static const std::unordered_set<x86_insn> UnbracketedAVX512Instructions {
-    X86_INS_KANDNB, X86_INS_KANDNW, X86_INS_KANDND, X86_INS_KANDNQ,
-        X86_INS_KMOVB, X86_INS_KMOVW, X86_INS_KMOVD, X86_INS_KMOVQ,
-        X86_INS_KUNPCKBW, X86_INS_KNOTB, X86_INS_KNOTW, X86_INS_KNOTD,
-        X86_INS_KNOTQ, X86_INS_KORB, X86_INS_KORW, X86_INS_KORD, X86_INS_KORQ,
-        X86_INS_KORTESTB, X86_INS_KORTESTW, X86_INS_KORTESTD, X86_INS_KORTESTQ,
-        X86_INS_KSHIFTLB, X86_INS_KSHIFTLW, X86_INS_KSHIFTLD, X86_INS_KSHIFTLQ,
-        X86_INS_KSHIFTRB, X86_INS_KSHIFTRW, X86_INS_KSHIFTRD, X86_INS_KSHIFTRQ,
-        X86_INS_KXNORB, X86_INS_KXNORW, X86_INS_KXNORD, X86_INS_KXNORQ,
-        X86_INS_KXORB, X86_INS_KXORW, X86_INS_KXORD, X86_INS_KXORQ,
-#if CS_API_MAJOR >= 5
-        X86_INS_KUNPCKDQ, X86_INS_KUNPCKWD, X86_INS_KADDB, X86_INS_KADDW,
-        X86_INS_KADDD, X86_INS_KADDQ, X86_INS_KTESTB, X86_INS_KTESTW,
-        X86_INS_KTESTD, X86_INS_KTESTQ, X86_INS_VPCMPESTRI
-#endif
-  };
-
-  static const std::unordered_set<x86_insn> BracketedSecondKAVX512Instrs{
-      X86_INS_VPCMPB,    X86_INS_VPCMPD,    X86_INS_VPCMPQ,
-      X86_INS_VPCMPW,    X86_INS_VPCMPUB,   X86_INS_VPCMPUD,
-      X86_INS_VPCMPUQ,   X86_INS_VPCMPUW,   X86_INS_VPCMPEQB,
-      X86_INS_VPCMPEQD,  X86_INS_VPCMPEQQ,  X86_INS_VPCMPEQW,
-      X86_INS_VPCMPGTB,  X86_INS_VPCMPGTD,  X86_INS_VPCMPGTQ,
-      X86_INS_VPCMPGTW,  X86_INS_VPTEST,    X86_INS_VPTESTMB,
-      X86_INS_VPTESTMD,  X86_INS_VPTESTMQ,  X86_INS_VPTESTMW,
-      X86_INS_VPTESTNMB, X86_INS_VPTESTNMD, X86_INS_VPTESTNMQ,
-      X86_INS_VPTESTNMW,
-  };
-
   bool IsBracketedAVX512Instruction =
-      UnbracketedAVX512Instructions.count(static_cast<x86_insn>(inst.id)) == 0;
+      !X86Instructions.has(inst.id, UnbracketedMaskOperands);
 
   bool IsBracketedSecondKAVX512Instr =
-      BracketedSecondKAVX512Instrs.count(static_cast<x86_insn>(inst.id)) != 0;
+      X86Instructions.has(inst.id, BracketedSecondMaskOperand);
 
   // For some of the AVX512 instrutions
-  // (listed in BracketedSecondKAVX512Instrs),
+  // (see BracketedSecondMaskOperand),
   // the first K register is not bracketed.
   // E.g., vpcmpnequb (%rdi),%ymm18,%k1{%k2}
   // For such instructions, have BracketedK initially set to false
@@ -887,8 +956,7 @@ void PrettyPrinterBase::printOperand(std::ostream& os,
     printOpRegdirect(os, inst, index);
     return;
   case X86_OP_IMM:
-    symbolic = block.getByteInterval()->getSymbolicExpression(
-        ea + immOffset - *block.getByteInterval()->getAddress());
+    symbolic = getSymbolicOperand(block, ea + immOffset);
     printOpImmediate(os, symbolic, inst, index);
     return;
   case X86_OP_MEM:
@@ -897,14 +965,12 @@ void PrettyPrinterBase::printOperand(std::ostream& os,
     // to populate the symbolic expressions, so we find the corresponding
     // symbolic by coincidence, but the addresses are incorrect.
     // We should fix Capstone and check `dispOffset > 0` here.
-    symbolic = block.getByteInterval()->getSymbolicExpression(
-        ea + dispOffset - *block.getByteInterval()->getAddress());
+    symbolic = getSymbolicOperand(block, ea + dispOffset);
     // We had a bug where Capstone gave us a displacement offset of 0 for
     // instructions using moffset operand encoding. For backwards
     // compatibility, look there for a symbolic expression.
     if (!symbolic && x86InstHasMoffsetEncoding(inst)) {
-      symbolic = block.getByteInterval()->getSymbolicExpression(
-          ea - *block.getByteInterval()->getAddress());
+      symbolic = getSymbolicOperand(block, ea);
       if (symbolic) {
         static bool warned;
         if (!warned) {
@@ -993,9 +1059,8 @@ void PrettyPrinterBase::printBlockImpl(std::ostream& os, BlockType& block) {
     }
   }
   // Print function ends if applicable
-  if (FunctionLastBlocks.count(block.getUUID()) > 0) {
-    const gtirb::Symbol* FunctionSymbol =
-        getContainerFunctionSymbol(block.getUUID());
+  if (isLastBlockOfFunction(block)) {
+    const gtirb::Symbol* FunctionSymbol = getContainerFunctionSymbol(block);
     // A function could have no name associated to it.
     if (FunctionSymbol) {
       printFunctionEnd(os, *FunctionSymbol);
@@ -1027,13 +1092,19 @@ void PrettyPrinterBase::printBlockContents(std::ostream& os,
     return;
   }
 
-  const auto* foundSymbolic =
-      dataObject.getByteInterval()->getSymbolicExpression(
-          dataObject.getOffset() + offset);
-  auto dataObjectBytes = dataObject.bytes<uint8_t>();
-  if (std::all_of(dataObjectBytes.begin() + offset, dataObjectBytes.end(),
-                  [](uint8_t x) { return x == 0; }) &&
-      !foundSymbolic)
+  // A block is printed as zeros only if none of its bytes is covered by a
+  // symbolic expression. Bytes past the initialized part read as zero.
+  uint64_t Begin = dataObject.getOffset();
+  bool HasSymbolic = !symbolicExpressionsBetween(*dataObject.getByteInterval(),
+                                                 Begin + offset,
+                                                 Begin + dataObject.getSize())
+                          .empty();
+  uint64_t Initialized = getInitializedBlockSize(dataObject);
+  bool AllZero = offset >= Initialized ||
+                 byte_run_length(dataObject.rawBytes<uint8_t>() + offset,
+                                 Initialized - offset,
+                                 0) == Initialized - offset;
+  if (AllZero && !HasSymbolic)
     printZeroDataBlock(os, dataObject, offset);
   else
     printNonZeroDataBlock(os, dataObject, offset);
@@ -1060,9 +1131,9 @@ void PrettyPrinterBase::printNonZeroDataBlock(
     return;
   }
 
-  // Otherwise, print each byte and/or symbolic expression in order.
-  auto ByteRange = dataObject.bytes<uint8_t>();
-  uint64_t ByteI = dataObject.getOffset() + offset;
+  // Otherwise, print each run of bytes and/or symbolic expression in order.
+  const uint8_t* Data = dataObject.rawBytes<uint8_t>();
+  uint64_t Initialized = getInitializedBlockSize(dataObject);
 
   // print comments at the right location efficiently (with a single iterator).
   bool HasComments = false;
@@ -1088,51 +1159,173 @@ void PrettyPrinterBase::printNonZeroDataBlock(
     }
   };
 
-  for (auto ByteIt = ByteRange.begin() + offset; ByteIt != ByteRange.end();) {
-
-    if (auto FoundSymExprRange =
-            dataObject.getByteInterval()->findSymbolicExpressionsAtOffset(
-                ByteI);
-        !FoundSymExprRange.empty()) {
-      const auto SEE = FoundSymExprRange.front();
-      auto Size = getSymbolicExpressionSize(SEE);
+  for (const DataRun& Run : classifyDataBlock(dataObject, offset)) {
+    switch (Run.RunKind) {
+    case DataRun::Kind::SymbolicExpression: {
       if (HasComments) {
-        printCommentsBetween(Size);
+        printCommentsBetween(Run.Size);
       }
       gtirb::Addr EA = *dataObject.getAddress() + CurrOffset.Displacement;
       std::stringstream DataLine;
       printEA(DataLine, EA);
-      printSymbolicData(DataLine, SEE, Size, Type);
-      if (Size == 0) {
-        LOG_ERROR
-            << "ERROR: " << EA
-            << ": Size 0 SymbolicExpression: break infinite loop of printing\n";
+      printSymbolicData(DataLine, *Run.SEE, Run.Size, Type);
+      if (Run.Size == 0) {
+        LOG_ERROR << "ERROR: " << EA << ": Size 0 SymbolicExpression\n";
       }
       printCommentableLine(DataLine, os, *dataObject.getAddress() + offset);
       os << '\n';
       printSymbolicDataFollowingComments(os, EA);
-      ByteI += Size;
-      ByteIt += Size;
-      CurrOffset.Displacement += Size;
-    } else {
+      CurrOffset.Displacement += Run.Size;
+      break;
+    }
+    case DataRun::Kind::Repeat: {
       if (HasComments) {
-        printCommentsBetween(1);
+        printCommentsBetween(Run.Size);
       }
-
+      gtirb::Addr EA = *dataObject.getAddress() + CurrOffset.Displacement;
       std::stringstream DataLine;
-      printEA(DataLine, *dataObject.getAddress() + CurrOffset.Displacement);
-      printByte(DataLine,
-                static_cast<std::byte>(static_cast<unsigned char>(*ByteIt)));
-      printCommentableLine(DataLine, os,
-                           *dataObject.getAddress() + CurrOffset.Displacement);
+      printEA(DataLine, EA);
+      printByteRun(DataLine, static_cast<std::byte>(Run.Value), Run.Size);
+      printCommentableLine(DataLine, os, EA);
       os << '\n';
-      ByteI++;
-      ByteIt++;
-      CurrOffset.Displacement++;
+      CurrOffset.Displacement += Run.Size;
+      break;
+    }
+    case DataRun::Kind::Bytes:
+      for (uint64_t I = Run.Offset; I < Run.Offset + Run.Size; ++I) {
+        if (HasComments) {
+          printCommentsBetween(1);
+        }
+
+        gtirb::Addr EA = *dataObject.getAddress() + CurrOffset.Displacement;
+        std::stringstream DataLine;
+        printEA(DataLine, EA);
+        printByte(DataLine, static_cast<std::byte>(I < Initialized ? Data[I]
+                                                                   : 0));
+        printCommentableLine(DataLine, os, EA);
+        os << '\n';
+        CurrOffset.Displacement++;
+      }
+      break;
     }
   }
 }
 
+const gtirb::SymbolicExpression*
+PrettyPrinterBase::getSymbolicOperand(const gtirb::CodeBlock& Block,
+                                      gtirb::Addr EA) {
+  const gtirb::ByteInterval* BI = Block.getByteInterval();
+  uint64_t Offset = EA - *BI->getAddress();
+  uint64_t Begin = Block.getOffset();
+  if (Offset < Begin || Offset >= Begin + Block.getSize()) {
+    return BI->getSymbolicExpression(Offset);
+  }
+
+  if (OperandBlock != &Block) {
+    OperandBlock = &Block;
+    OperandOffsets.clear();
+    OperandExpressions.clear();
+    for (const auto& SEE : BI->findSymbolicExpressionsAtOffset(
+             Begin, Begin + Block.getSize())) {
+      OperandOffsets.push_back(SEE.getOffset());
+      OperandExpressions.push_back(&SEE.getSymbolicExpression());
+    }
+  }
+
+  auto It =
+      std::lower_bound(OperandOffsets.begin(), OperandOffsets.end(), Offset);
+  if (It == OperandOffsets.end() || *It != Offset) {
+    return nullptr;
+  }
+  return OperandExpressions[It - OperandOffsets.begin()];
+}
+
+gtirb::ByteInterval::const_symbolic_expression_range
+PrettyPrinterBase::symbolicExpressionsBetween(const gtirb::ByteInterval& BI,
+                                              uint64_t Low, uint64_t High) {
+  SymbolicExpressionCursor& C = SymExprCursor;
+  if (C.BI != &BI || Low < C.Low) {
+    auto Range = BI.findSymbolicExpressionsAtOffset(Low, BI.getSize());
+    C = {&BI, Low, Range.begin(), Range.end()};
+  }
+  C.Low = Low;
+  while (C.It != C.End && (*C.It).getOffset() < Low) {
+    ++C.It;
+  }
+  auto Last = C.It;
+  while (Last != C.End && (*Last).getOffset() < High) {
+    ++Last;
+  }
+  return {C.It, Last};
+}
+
+std::vector<PrettyPrinterBase::DataRun>
+PrettyPrinterBase::classifyDataBlock(const gtirb::DataBlock& Block,
+                                     uint64_t Offset) {
+  std::vector<DataRun> Runs;
+  const gtirb::ByteInterval* BI = Block.getByteInterval();
+  const uint8_t* Data = Block.rawBytes<uint8_t>();
+  uint64_t Initialized = getInitializedBlockSize(Block);
+
+  // Split [Start, End), which holds no symbolic expression, into runs of a
+  // repeated byte and the bytes in between.
+  auto addBytes = [&](uint64_t Start, uint64_t End) {
+    while (Start < End) {
+      uint8_t Value = 0;
+      uint64_t Length = End - Start;
+      if (Start < Initialized) {
+        Value = Data[Start];
+        Length = byte_run_length(Data + Start,
+                                 std::min(End, Initialized) - Start, Value);
+        // A run of zeros continues into the uninitialized tail.
+        if (Value == 0 && Start + Length == Initialized) {
+          Length = End - Start;
+        }
+      }
+      if (Length >= MinDataRun) {
+        Runs.push_back({DataRun::Kind::Repeat, Start, Length, Value});
+      } else if (!Runs.empty() && Runs.back().RunKind == DataRun::Kind::Bytes &&
+                 Runs.back().Offset + Runs.back().Size == Start) {
+        Runs.back().Size += Length;
+      } else {
+        Runs.push_back({DataRun::Kind::Bytes, Start, Length});
+      }
+      Start += Length;
+    }
+  };
+
+  uint64_t Begin = Block.getOffset();
+  uint64_t Next = Offset;
+  for (const auto& SEE : symbolicExpressionsBetween(*BI, Begin + Offset,
+                                                    Begin + Block.getSize())) {
+    uint64_t SymOffset = SEE.getOffset() - Begin;
+    // Skip symbolic expressions covered by the previous one.
+    if (SymOffset < Next) {
+      continue;
+    }
+    addBytes(Next, SymOffset);
+    uint64_t Size = getSymbolicExpressionSize(SEE);
+    Runs.push_back(
+        {DataRun::Kind::SymbolicExpression, SymOffset, Size, 0, SEE});
+    Next = SymOffset + Size;
+  }
+  addBytes(Next, Block.getSize());
+  return Runs;
+}
+
+void PrettyPrinterBase::printByteRun(std::ostream& os, std::byte byte,
+                                     uint64_t Count) {
+  if (byte == std::byte(0)) {
+    os << ".zero ";
+    write_dec(os, Count);
+  } else {
+    os << ".fill ";
+    write_dec(os, Count);
+    os << ", 1, 0x";
+    write_hex(os, static_cast<uint8_t>(byte));
+  }
+}
+
 void PrettyPrinterBase::printZeroDataBlock(std::ostream& os,
                                            const gtirb::DataBlock& dataObject,
                                            uint64_t offset) {
@@ -1142,7 +1335,8 @@ void PrettyPrinterBase::printZeroDataBlock(std::ostream& os,
 
     std::stringstream DataLine;
     printEA(DataLine, *dataObject.getAddress() + offset);
-    DataLine << ".zero " << size;
+    DataLine << ".zero ";
+    write_dec(DataLine, size);
     printCommentableLine(DataLine, os, *dataObject.getAddress() + offset);
     os << '\n';
   }
@@ -1352,7 +1546,7 @@ void PrettyPrinterBase::printSymbolicExpression(std::ostream& os,
 std::optional<std::string>
 PrettyPrinterBase::getContainerFunctionName(gtirb::Addr Addr) const {
   for (auto& Block : module.findBlocksOn(Addr)) {
-    auto FunctionSymbol = getContainerFunctionSymbol(Block.getUUID());
+    auto FunctionSymbol = getContainerFunctionSymbol(Block);
     if (FunctionSymbol) {
       return FunctionSymbol->getName();
     }
@@ -1361,15 +1555,19 @@ PrettyPrinterBase::getContainerFunctionName(gtirb::Addr Addr) const {
 }
 
 const gtirb::Symbol*
-PrettyPrinterBase::getContainerFunctionSymbol(const gtirb::UUID& Uuid) const {
-  if (auto FunctionEntry = BlockToFunction.find(Uuid);
-      FunctionEntry != BlockToFunction.end()) {
-    if (auto FunctionNameEntry = FunctionToSymbols.find(FunctionEntry->second);
-        FunctionNameEntry != FunctionToSymbols.end()) {
-      return FunctionNameEntry->second;
-    }
-  }
-  return nullptr;
+PrettyPrinterBase::getContainerFunctionSymbol(const gtirb::Node& Block) const {
+  auto It = FunctionBlockInfos.find(&Block);
+  return It != FunctionBlockInfos.end() ? It->second.FunctionSymbol : nullptr;
+}
+
+bool PrettyPrinterBase::isFirstBlockOfFunction(const gtirb::Node& Block) const {
+  auto It = FunctionBlockInfos.find(&Block);
+  return It != FunctionBlockInfos.end() && It->second.First;
+}
+
+bool PrettyPrinterBase::isLastBlockOfFunction(const gtirb::Node& Block) const {
+  auto It = FunctionBlockInfos.find(&Block);
+  return It != FunctionBlockInfos.end() && It->second.Last;
 }
 
 bool PrettyPrinterBase::isFunctionSkipped(
@@ -1431,7 +1629,7 @@ bool PrettyPrinterBase::shouldSkip(const PrintingPolicy& Policy,
     auto BlocksAtSymbolAddr = module.findBlocksAt(*Addr);
     if (BlocksAtSymbolAddr.begin() != BlocksAtSymbolAddr.end()) {
       auto FunctionSymbol =
-          getContainerFunctionSymbol(BlocksAtSymbolAddr.begin()->getUUID());
+          getContainerFunctionSymbol(*BlocksAtSymbolAddr.begin());
       return FunctionSymbol && isFunctionSkipped(Policy, *FunctionSymbol);
     }
     return false;
@@ -1451,7 +1649,7 @@ bool PrettyPrinterBase::shouldSkip(const PrintingPolicy& Policy,
     return true;
   }
 
-  auto FunctionSymbol = getContainerFunctionSymbol(block.getUUID());
+  auto FunctionSymbol = getContainerFunctionSymbol(block);
   return FunctionSymbol && isFunctionSkipped(Policy, *FunctionSymbol);
 }
 
@@ -1466,7 +1664,7 @@ bool PrettyPrinterBase::shouldSkip(const PrintingPolicy& Policy,
     return true;
   }
 
-  auto FunctionSymbol = getContainerFunctionSymbol(block.getUUID());
+  auto FunctionSymbol = getContainerFunctionSymbol(block);
   return FunctionSymbol && isFunctionSkipped(Policy, *FunctionSymbol);
 }
 
@@ -1484,15 +1682,31 @@ std::string PrettyPrinterBase::getRegisterName(unsigned int reg) const {
   return ascii_str_toupper(cs_reg_name(this->csHandle, reg));
 }
 
+std::string_view PrettyPrinterBase::getRegisterText(unsigned int Reg) const {
+  auto It = RegisterTexts.find(Reg);
+  if (It == RegisterTexts.end())
+    It = RegisterTexts.emplace(Reg, getRegisterName(Reg)).first;
+  return It->second;
+}
+
+std::string_view PrettyPrinterBase::getMnemonicText(const cs_insn& Inst) {
+  size_t Size = 0;
+  for (; Size < sizeof(Inst.mnemonic) && Inst.mnemonic[Size] != '\0'; ++Size)
+    MnemonicText[Size] = static_cast<char>(
+        std::tolower(static_cast<unsigned char>(Inst.mnemonic[Size])));
+  return std::string_view(MnemonicText, Size);
+}
+
 void PrettyPrinterBase::printAddend(std::ostream& os, int64_t number,
                                     bool first) {
   if (number < 0 || first) {
-    os << number;
+    write_dec(os, number);
     return;
   }
   if (number == 0)
     return;
-  os << "+" << number;
+  os << '+';
+  write_dec(os, number);
 }
 
 template <typename BlockType>
@@ -1503,25 +1717,10 @@ PrettyPrinterBase::getAlignmentImpl(const BlockType& Block) {
            (&Block.getByteInterval()->getSection()->byte_intervals().front() ==
             Block.getByteInterval());
 
-  // print alignment if block specified in aux data table
-  if (auto Alignment = aux_data::getAlignment(Block.getUUID(), module)) {
-    return Alignment;
-  }
-
-  // print alignment if byte interval specified in aux data table
-  if (FirstInBI) {
-    if (auto Alignment = aux_data::getAlignment(
-            Block.getByteInterval()->getUUID(), module)) {
-      return Alignment;
-    }
-
-    // print alignment if section specified in aux data table
-    if (FirstInSection) {
-      if (auto Alignment = aux_data::getAlignment(
-              Block.getByteInterval()->getSection()->getUUID(), module)) {
-        return Alignment;
-      }
-    }
+  // print alignment if the block, or the byte interval or section it is the
+  // first block of, is specified in aux data table
+  if (auto It = BlockAlignments.find(&Block); It != BlockAlignments.end()) {
+    return It->second;
   }
 
   // if the section is an array section, print the ISA's array section width
@@ -1599,6 +1798,23 @@ PrettyPrinterBase::getForwardedSymbolName(const gtirb::Symbol* Symbol) const {
   }
 }
 
+const std::string&
+PrettyPrinterBase::getSymbolText(const gtirb::Symbol& Symbol) const {
+  auto It = SymbolTexts.find(&Symbol);
+  if (It == SymbolTexts.end())
+    It = SymbolTexts.emplace(&Symbol, getSymbolName(Symbol)).first;
+  return It->second;
+}
+
+const std::optional<std::string>&
+PrettyPrinterBase::getForwardedSymbolText(const gtirb::Symbol* Symbol) const {
+  auto It = ForwardedSymbolTexts.find(Symbol);
+  if (It == ForwardedSymbolTexts.end())
+    It = ForwardedSymbolTexts.emplace(Symbol, getForwardedSymbolName(Symbol))
+             .first;
+  return It->second;
+}
+
 gtirb::Symbol*
 PrettyPrinterBase::getForwardedSymbol(const gtirb::Symbol* Symbol) const {
   if (Symbol) {
@@ -1647,9 +1863,16 @@ void PrettyPrinterBase::printSection(std::ostream& os,
 uint64_t PrettyPrinterBase::getSymbolicExpressionSize(
     const gtirb::ByteInterval::ConstSymbolicExpressionElement& SEE) const {
   // Check if it is present in aux data.
-  gtirb::Offset Off{SEE.getByteInterval()->getUUID(), SEE.getOffset()};
-  if (auto Size = aux_data::getSymbolicExpressionSize(Off, module)) {
-    return *Size;
+  if (auto It = SymExprSizes.find(SEE.getByteInterval());
+      It != SymExprSizes.end()) {
+    const auto& Sizes = It->second;
+    auto Found = std::lower_bound(Sizes.begin(), Sizes.end(), SEE.getOffset(),
+                                  [](const auto& Entry, uint64_t Offset) {
+                                    return Entry.first < Offset;
+                                  });
+    if (Found != Sizes.end() && Found->first == SEE.getOffset()) {
+      return Found->second;
+    }
   }
 
   // If not, it's the size of that largest data block at this address that is:
@@ -1693,6 +1916,16 @@ PrettyPrinterBase::getAlignment(gtirb::Addr Addr) const {
   return std::nullopt;
 }
 
+uint64_t
+PrettyPrinterBase::getInitializedBlockSize(const gtirb::DataBlock& Block) {
+  const gtirb::ByteInterval* BI = Block.getByteInterval();
+  if (!BI || BI->getInitializedSize() <= Block.getOffset()) {
+    return 0;
+  }
+  return std::min(Block.getSize(),
+                  BI->getInitializedSize() - Block.getOffset());
+}
+
 bool PrettyPrinterBase::x86InstHasMoffsetEncoding(const cs_insn& inst) {
   // The moffset operand encoding is only used by a handful of mov
   // instructions.
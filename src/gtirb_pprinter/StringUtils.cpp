@@ -17,6 +17,17 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <ostream>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                   \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GTIRB_PP_STRING_SSE2 1
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 std::string ascii_str_tolower(std::string s) {
   std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
@@ -31,3 +42,159 @@ std::string ascii_str_toupper(std::string s) {
   });
   return s;
 }
+
+namespace {
+
+// Bytes for which Syntax::escapeByte does not return the byte itself.
+bool isEscaped(uint8_t Byte) {
+  switch (Byte) {
+  case '\\':
+  case '"':
+  case '\n':
+  case '\t':
+  case '\b':
+  case '\f':
+  case '\r':
+  case '\a':
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool isUnescaped(uint8_t Byte) { return Byte != 0 && !isEscaped(Byte); }
+
+bool isPrintable(uint8_t Byte) { return Byte >= 0x20 && Byte <= 0x7e; }
+
+#ifdef GTIRB_PP_STRING_SSE2
+unsigned countTrailingZeros(uint32_t Mask) {
+#if defined(_MSC_VER)
+  unsigned long Index;
+  _BitScanForward(&Index, Mask);
+  return static_cast<unsigned>(Index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(Mask));
+#endif
+}
+
+// The vector kernels below compute, for a block of bytes, a mask with one bit
+// set for each byte that ends the prefix. Unsigned range checks use
+// min(X - Lo, Hi - Lo) == X - Lo, as SSE2 has no unsigned byte comparison.
+
+#ifdef __AVX2__
+uint32_t unescapedStops(__m256i V) {
+  auto Eq = [V](char C) { return _mm256_cmpeq_epi8(V, _mm256_set1_epi8(C)); };
+  // '\a' through '\r', except '\v', are escaped.
+  __m256i Ctl = _mm256_sub_epi8(V, _mm256_set1_epi8('\a'));
+  Ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(Ctl, _mm256_set1_epi8(6)), Ctl);
+  Ctl = _mm256_andnot_si256(Eq('\v'), Ctl);
+  __m256i Stops = _mm256_or_si256(
+      _mm256_or_si256(Eq(0), Ctl), _mm256_or_si256(Eq('"'), Eq('\\')));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(Stops));
+}
+
+uint32_t printableStops(__m256i V) {
+  __m256i X = _mm256_sub_epi8(V, _mm256_set1_epi8(0x20));
+  __m256i In = _mm256_cmpeq_epi8(_mm256_min_epu8(X, _mm256_set1_epi8(0x5e)), X);
+  return ~static_cast<uint32_t>(_mm256_movemask_epi8(In));
+}
+
+uint32_t mismatchStops(__m256i V, uint8_t Value) {
+  __m256i Eq = _mm256_cmpeq_epi8(V, _mm256_set1_epi8(static_cast<char>(Value)));
+  return ~static_cast<uint32_t>(_mm256_movemask_epi8(Eq));
+}
+#endif
+
+uint32_t unescapedStops(__m128i V) {
+  auto Eq = [V](char C) { return _mm_cmpeq_epi8(V, _mm_set1_epi8(C)); };
+  // '\a' through '\r', except '\v', are escaped.
+  __m128i Ctl = _mm_sub_epi8(V, _mm_set1_epi8('\a'));
+  Ctl = _mm_cmpeq_epi8(_mm_min_epu8(Ctl, _mm_set1_epi8(6)), Ctl);
+  Ctl = _mm_andnot_si128(Eq('\v'), Ctl);
+  __m128i Stops =
+      _mm_or_si128(_mm_or_si128(Eq(0), Ctl), _mm_or_si128(Eq('"'), Eq('\\')));
+  return static_cast<uint32_t>(_mm_movemask_epi8(Stops));
+}
+
+uint32_t printableStops(__m128i V) {
+  __m128i X = _mm_sub_epi8(V, _mm_set1_epi8(0x20));
+  __m128i In = _mm_cmpeq_epi8(_mm_min_epu8(X, _mm_set1_epi8(0x5e)), X);
+  return ~static_cast<uint32_t>(_mm_movemask_epi8(In)) & 0xffff;
+}
+
+uint32_t mismatchStops(__m128i V, uint8_t Value) {
+  __m128i Eq = _mm_cmpeq_epi8(V, _mm_set1_epi8(static_cast<char>(Value)));
+  return ~static_cast<uint32_t>(_mm_movemask_epi8(Eq)) & 0xffff;
+}
+#endif
+
+// Scan with the widest available vector kernel, then finish the tail with
+// the scalar predicate.
+template <typename VectorStops, typename ScalarPredicate>
+size_t prefix(const uint8_t* Data, size_t Size,
+              [[maybe_unused]] VectorStops Stops, ScalarPredicate Pred) {
+  size_t I = 0;
+#ifdef GTIRB_PP_STRING_SSE2
+#ifdef __AVX2__
+  for (; I + 32 <= Size; I += 32) {
+    __m256i V =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Data + I));
+    if (uint32_t Mask = Stops(V)) {
+      return I + countTrailingZeros(Mask);
+    }
+  }
+#endif
+  for (; I + 16 <= Size; I += 16) {
+    __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + I));
+    if (uint32_t Mask = Stops(V)) {
+      return I + countTrailingZeros(Mask);
+    }
+  }
+#endif
+  while (I < Size && Pred(Data[I])) {
+    ++I;
+  }
+  return I;
+}
+
+} // namespace
+
+size_t ascii_unescaped_prefix(const uint8_t* Data, size_t Size) {
+  return prefix(
+      Data, Size, [](auto V) { return unescapedStops(V); }, isUnescaped);
+}
+
+size_t ascii_printable_prefix(const uint8_t* Data, size_t Size) {
+  return prefix(
+      Data, Size, [](auto V) { return printableStops(V); }, isPrintable);
+}
+
+size_t byte_run_length(const uint8_t* Data, size_t Size, uint8_t Value) {
+  return prefix(
+      Data, Size, [Value](auto V) { return mismatchStops(V, Value); },
+      [Value](uint8_t Byte) { return Byte == Value; });
+}
+
+template <typename T>
+static void write_integer(std::ostream& OS, T Value, int Base,
+                          size_t MinDigits) {
+  // Enough for a sign and the 64 binary digits of any supported base.
+  char Buffer[65];
+  char* End = std::to_chars(Buffer, Buffer + sizeof(Buffer), Value, Base).ptr;
+  size_t Size = End - Buffer;
+  for (; MinDigits > Size; --MinDigits)
+    OS.put('0');
+  OS.write(Buffer, Size);
+}
+
+void write_signed_dec(std::ostream& OS, int64_t Value) {
+  write_integer(OS, Value, 10, 1);
+}
+
+void write_unsigned_dec(std::ostream& OS, uint64_t Value) {
+  write_integer(OS, Value, 10, 1);
+}
+
+void write_hex(std::ostream& OS, uint64_t Value, size_t MinDigits) {
+  write_integer(OS, Value, 16, MinDigits);
+}
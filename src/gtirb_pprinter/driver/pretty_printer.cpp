@@ -8,6 +8,7 @@
 #include <gtirb_layout/gtirb_layout.hpp>
 #include <gtirb_pprinter/ElfBinaryPrinter.hpp>
 #include <gtirb_pprinter/ElfVersionScriptPrinter.hpp>
+#include <gtirb_pprinter/FileUtils.hpp>
 #include <gtirb_pprinter/Fixup.hpp>
 #include <gtirb_pprinter/PeBinaryPrinter.hpp>
 #include <gtirb_pprinter/PrettyPrinter.hpp>
@@ -61,14 +62,17 @@ getBinaryPrinter(const std::string& format,
                  const gtirb_pprint::PrettyPrinter& pp,
                  const std::vector<std::string>& extraCompileArgs,
                  const std::vector<std::string>& libraryPaths,
-                 const std::string& gccExecutable, bool dummySO) {
+                 const std::string& gccExecutable, bool dummySO,
+                 const gtirb_bprint::ElfBinaryPrinterOptions& elfOptions,
+                 const std::string& importLibCacheDir) {
   std::unique_ptr<gtirb_bprint::BinaryPrinter> binaryPrinter;
   if (format == "elf")
     return std::make_unique<gtirb_bprint::ElfBinaryPrinter>(
-        pp, gccExecutable, extraCompileArgs, libraryPaths, true, dummySO);
+        pp, gccExecutable, extraCompileArgs, libraryPaths, true, dummySO,
+        elfOptions);
   if (format == "pe")
-    return std::make_unique<gtirb_bprint::PeBinaryPrinter>(pp, extraCompileArgs,
-                                                           libraryPaths);
+    return std::make_unique<gtirb_bprint::PeBinaryPrinter>(
+        pp, extraCompileArgs, libraryPaths, importLibCacheDir);
   return nullptr;
 }
 
@@ -161,6 +165,10 @@ int main(int argc, char** argv) {
                      "arm, arm64, att, intel, masm, mips32");
   desc.add_options()("layout,l", "Layout code and data in memory to "
                                  "avoid overlap");
+  desc.add_options()(
+      "incremental-layout",
+      "When laying out a module, keep the addresses of sections that do not "
+      "need to move, and only place the sections from the first overlap on.");
   desc.add_options()(
       "listing-mode", po::value<std::string>(),
       "The mode of use for the listing: assembler, ui, or debug");
@@ -221,8 +229,37 @@ int main(int argc, char** argv) {
   desc.add_options()("dummy-so", po::value<bool>()->default_value(false),
                      "Use artificial .so files for linking rather than actual "
                      "libraries. Only relevant for ELF executables.");
+  desc.add_options()(
+      "dummy-so-native", po::value<bool>()->default_value(false),
+      "Write artificial .so files directly instead of assembling them with "
+      "the compiler. Only relevant with --dummy-so, and only for x86-64; "
+      "other ISAs still assemble them.");
+  desc.add_options()(
+      "dummy-so-cache", po::value<std::string>()->value_name("DIR"),
+      "Reuse artificial .so files across runs by caching them in DIR. Only "
+      "relevant with --dummy-so. Files written with --dummy-so-native are "
+      "not cached.");
+  desc.add_options()(
+      "fixup-cache", po::value<std::string>()->value_name("DIR"),
+      "Reuse the result of the shared-object fixup across runs on the same "
+      "GTIRB file by caching it in DIR. Only relevant for ELF shared objects.");
+  desc.add_options()(
+      "import-lib-cache", po::value<std::string>()->value_name("DIR"),
+      "Reuse PE import libraries across runs by caching them in DIR. Only "
+      "relevant for PE binaries.");
+  desc.add_options()(
+      "object-direct", po::value<bool>()->default_value(false),
+      "Write x86-64 ELF object files directly instead of assembling the "
+      "printed assembly. Modules that cannot be written directly are "
+      "assembled as usual.");
   desc.add_options()("use-gcc", po::value<std::string>(),
                      "Specify the gcc binary to use for ELF binary printing.");
+  desc.add_options()(
+      "use-ld", po::value<std::string>()->value_name("NAME"),
+      "Link ELF binaries with the linker NAME (e.g. mold, lld, gold), passed "
+      "to the compiler with -fuse-ld. Use 'auto' to pick mold or lld if "
+      "available. The default linker is used if the requested one is not "
+      "available or does not support the required options.");
   desc.add_options()(
       "symbol-versions", po::value<bool>()->default_value(true),
       "Enable symbol versions. If symbol versions are considered many "
@@ -311,6 +348,23 @@ int main(int argc, char** argv) {
     LOG_ERROR << "Failed to load the GTIRB data from the file.\n";
     return EXIT_FAILURE;
   }
+
+  // Fixups are cached by the contents of the GTIRB file they were computed
+  // from, so they can only be cached when reading from a file.
+  std::string FixupCacheDir;
+  std::string IRKey;
+  if (vm.count("fixup-cache") != 0) {
+    std::optional<std::string> Key;
+    if (vm.count("ir") != 0) {
+      Key = gtirb_bprint::FileCache::fileKey(vm["ir"].as<std::string>());
+    }
+    if (Key) {
+      FixupCacheDir = vm["fixup-cache"].as<std::string>();
+      IRKey = *Key;
+    } else {
+      LOG_WARNING << "Not caching fixups: the GTIRB file cannot be hashed.\n";
+    }
+  }
   if (ir->modules().empty()) {
     LOG_ERROR << "GTIRB file contains no modules.\n";
     return EXIT_FAILURE;
@@ -515,37 +569,65 @@ int main(int argc, char** argv) {
     }
   }
 
+  auto applyLayout = [&](gtirb::Module& M) {
+    if (vm.count("incremental-layout")) {
+      size_t Moved = 0;
+      gtirb_layout::layoutModuleIncremental(ctx, M, &Moved);
+      LOG_INFO << "Moved " << Moved << " byte intervals in module "
+               << M.getName() << std::endl;
+    } else {
+      gtirb_layout::layoutModule(ctx, M);
+    }
+  };
+
   for (auto& MP : Modules) {
     auto& M = *(MP.Module);
-    // Layout IR in memory without overlap.
+    // Layout IR in memory without overlap. LayoutAction records what was
+    // done to the module, since the fixups depend on it.
+    std::string LayoutAction = "none";
     if (vm.count("layout")) {
       LOG_INFO << "Applying new layout to module " << M.getUUID() << "..."
                << std::endl;
-      gtirb_layout::layoutModule(ctx, M);
+      applyLayout(M);
       new_layout = true;
+      LayoutAction = "layout";
     } else {
       auto SkipSections = pp.getPolicy(M).skipSections;
       pp.sectionPolicy().apply(SkipSections);
-      if (gtirb_layout::layoutRequired(M, SkipSections)) {
-        gtirb_layout::layoutModule(ctx, M);
+      auto Health = gtirb_layout::cacheLayoutHealth(M, SkipSections);
+      LOG_INFO << "Layout of module " << M.getName() << ": "
+               << Health.UnaddressedSections << " unaddressed sections, "
+               << Health.Overlaps << " overlaps, " << Health.IntegralSymbols
+               << " integral symbols" << std::endl;
+      if (Health.LayoutRequired) {
+        applyLayout(M);
         new_layout = true;
+        LayoutAction = "layout";
       }
     }
+    if (LayoutAction == "layout" && vm.count("incremental-layout")) {
+      LayoutAction = "incremental-layout";
+    }
     if (!new_layout) {
-      if (std::any_of(M.symbols_begin(), M.symbols_end(),
-                      [](const gtirb::Symbol& Sym) {
-                        return !Sym.hasReferent() && Sym.getAddress();
-                      })) {
+      // Reuse the layout summary cached on the module above.
+      auto Health = gtirb_layout::getCachedLayoutHealth(M);
+      if (Health && Health->IntegralSymbols != 0) {
         LOG_INFO << "Module " << M.getName()
                  << " has integral symbols; attempting to assign referents..."
                  << std::endl;
         gtirb_layout::fixIntegralSymbols(ctx, M);
+        LayoutAction = "integral-symbols";
       }
     }
     // Update DynMode (-shared or -pie or none) for the module
     pp.updateDynMode(M, SharedOption);
     // Apply any needed fixups
-    applyFixups(ctx, M, pp);
+    if (FixupCacheDir.empty()) {
+      applyFixups(ctx, M, pp);
+    } else {
+      applyFixups(ctx, M, pp, FixupCacheDir,
+                  gtirb_bprint::FileCache::key({IRKey, LayoutAction}));
+    }
     // Write version script to a file
     if (MP.VersionScriptName) {
       LOG_INFO << "Generating version script for module " << M.getName()
@@ -616,10 +698,21 @@ int main(int argc, char** argv) {
       std::string gccExecutable;
       if (vm.count("use-gcc") != 0)
         gccExecutable = vm["use-gcc"].as<std::string>();
+      gtirb_bprint::ElfBinaryPrinterOptions elfOptions;
+      if (vm.count("dummy-so-cache") != 0)
+        elfOptions.DummySOCacheDir = vm["dummy-so-cache"].as<std::string>();
+      elfOptions.NativeDummySO = vm["dummy-so-native"].as<bool>();
+      elfOptions.ObjectDirect = vm["object-direct"].as<bool>();
+      if (vm.count("use-ld") != 0)
+        elfOptions.Linker = vm["use-ld"].as<std::string>();
+      std::string importLibCacheDir;
+      if (vm.count("import-lib-cache") != 0)
+        importLibCacheDir = vm["import-lib-cache"].as<std::string>();
 
       std::unique_ptr<gtirb_bprint::BinaryPrinter> binaryPrinter =
           getBinaryPrinter(format, pp, extraCompilerArgs, libraryPaths,
-                           gccExecutable, vm["dummy-so"].as<bool>());
+                           gccExecutable, vm["dummy-so"].as<bool>(),
+                           elfOptions, importLibCacheDir);
       if (!binaryPrinter) {
         LOG_ERROR << "'" << format
                   << "' is an unsupported binary printing format.\n";
@@ -0,0 +1,50 @@
+#include <capstone/capstone.h>
+#include <gtest/gtest.h>
+#include <gtirb_pprinter/ArmPrettyPrinter.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace gtirb_pprint;
+
+static const std::vector<size_t> ThumbModes = {
+    CS_MODE_THUMB | CS_MODE_V8,
+    CS_MODE_THUMB | CS_MODE_V8 | CS_MODE_MCLASS,
+    CS_MODE_THUMB,
+    CS_MODE_THUMB | CS_MODE_MCLASS,
+};
+
+TEST(Unit_ArmCsModeOrder, NoArchInfo) {
+  ArmCsModeOrder Order(ThumbModes, {});
+  EXPECT_EQ(Order.modes(), ThumbModes);
+}
+
+TEST(Unit_ArmCsModeOrder, ProfileM) {
+  ArmCsModeOrder Order(ThumbModes, {{"Profile", "M"}});
+  const std::vector<size_t> Expected = {
+      CS_MODE_THUMB | CS_MODE_V8 | CS_MODE_MCLASS,
+      CS_MODE_THUMB | CS_MODE_MCLASS,
+      CS_MODE_THUMB | CS_MODE_V8,
+      CS_MODE_THUMB,
+  };
+  EXPECT_EQ(Order.modes(), Expected);
+}
+
+TEST(Unit_ArmCsModeOrder, Arch) {
+  ArmCsModeOrder V7(ThumbModes, {{"Arch", "v7"}});
+  EXPECT_EQ(V7.modes().front(), CS_MODE_THUMB);
+
+  ArmCsModeOrder V8(ThumbModes, {{"Arch", "v8"}, {"Profile", "A"}});
+  EXPECT_EQ(V8.modes().front(), CS_MODE_THUMB | CS_MODE_V8);
+
+  ArmCsModeOrder V81M(ThumbModes, {{"Arch", "v8.1-M.main"}, {"Profile", "M"}});
+  EXPECT_EQ(V81M.modes().front(), CS_MODE_THUMB | CS_MODE_V8 | CS_MODE_MCLASS);
+}
+
+TEST(Unit_ArmCsModeOrder, MalformedArch) {
+  // An unparsable version is ignored rather than thrown.
+  for (const char* Arch : {"", "v", "armv", "v99999999999999999999999"}) {
+    ArmCsModeOrder Order(ThumbModes, {{"Arch", Arch}});
+    EXPECT_EQ(Order.modes(), ThumbModes) << Arch;
+  }
+}
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <gtirb_pprinter/Parallel.hpp>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace gtirb_pprint;
+
+using Graph = std::vector<std::vector<size_t>>;
+
+// Two diamonds joined by a chain, so tasks become ready in several waves.
+static const Graph Diamonds = {
+    {}, {0}, {0}, {1, 2}, {3}, {4}, {4}, {5, 6}, {}, {7, 8},
+};
+
+// Each graph test runs on the calling thread alone and on a pool.
+static const std::vector<size_t> WorkerCounts = {1, 4};
+
+TEST(Unit_Parallel, DependenciesFinishFirst) {
+  for (size_t Workers : WorkerCounts) {
+    SCOPED_TRACE(Workers);
+    std::vector<std::atomic<bool>> Done(Diamonds.size());
+    std::atomic<size_t> Calls{0};
+    bool Succeeded = parallelForGraph(
+        Diamonds,
+        [&](size_t I) {
+          for (size_t D : Diamonds[I]) {
+            EXPECT_TRUE(Done[D]) << "task " << I << " started before " << D;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          Done[I] = true;
+          ++Calls;
+          return true;
+        },
+        Workers);
+    EXPECT_TRUE(Succeeded);
+    EXPECT_EQ(Calls, Diamonds.size());
+  }
+}
+
+TEST(Unit_Parallel, FailureStopsDependents) {
+  for (size_t Workers : WorkerCounts) {
+    SCOPED_TRACE(Workers);
+    std::mutex Mutex;
+    std::vector<size_t> Started;
+    bool Succeeded = parallelForGraph(
+        Diamonds,
+        [&](size_t I) {
+          std::lock_guard<std::mutex> Lock(Mutex);
+          Started.push_back(I);
+          return I != 3;
+        },
+        Workers);
+    EXPECT_FALSE(Succeeded);
+    for (size_t I : Started) {
+      // Everything after the failed task depends on it, except task 8.
+      EXPECT_TRUE(I <= 3 || I == 8) << "task " << I << " started";
+    }
+  }
+}
+
+TEST(Unit_Parallel, ExceptionReachesCaller) {
+  for (size_t Workers : WorkerCounts) {
+    SCOPED_TRACE(Workers);
+    std::atomic<bool> DependentRan{false};
+    EXPECT_THROW(parallelForGraph(
+                     Diamonds,
+                     [&](size_t I) -> bool {
+                       if (I == 4) {
+                         throw std::runtime_error("step failed");
+                       }
+                       if (I > 4 && I != 8) {
+                         DependentRan = true;
+                       }
+                       return true;
+                     },
+                     Workers),
+                 std::runtime_error);
+    EXPECT_FALSE(DependentRan);
+  }
+}
+
+TEST(Unit_Parallel, EmptyGraph) {
+  EXPECT_TRUE(parallelForGraph({}, [](size_t) { return false; }, 4));
+}
+
+TEST(Unit_Parallel, SingleWorkerStopsAfterFailure) {
+  // With one worker, tasks start in index order and nothing starts once a
+  // task has failed, even a task that does not depend on it.
+  std::vector<size_t> Started;
+  bool Succeeded = parallelForGraph(
+      Graph(4),
+      [&](size_t I) {
+        Started.push_back(I);
+        return I != 1;
+      },
+      1);
+  EXPECT_FALSE(Succeeded);
+  EXPECT_EQ(Started, std::vector<size_t>({0, 1}));
+}
+
+TEST(Unit_Parallel, IndependentTasksOverlap) {
+  // Each task waits for the other to start, which only finishes if they run
+  // at the same time.
+  std::atomic<size_t> Arrived{0};
+  bool Succeeded = parallelForGraph(
+      Graph(2),
+      [&](size_t) {
+        ++Arrived;
+        auto Deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (Arrived < 2 && std::chrono::steady_clock::now() < Deadline) {
+          std::this_thread::yield();
+        }
+        return Arrived == 2;
+      },
+      2);
+  EXPECT_TRUE(Succeeded);
+}
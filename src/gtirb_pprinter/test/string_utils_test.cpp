@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <gtirb_pprinter/StringUtils.hpp>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static size_t unescapedPrefix(const std::string& S) {
+  return ascii_unescaped_prefix(reinterpret_cast<const uint8_t*>(S.data()),
+                                S.size());
+}
+
+static size_t printablePrefix(const std::string& S) {
+  return ascii_printable_prefix(reinterpret_cast<const uint8_t*>(S.data()),
+                                S.size());
+}
+
+TEST(Unit_StringUtils, UnescapedPrefix) {
+  EXPECT_EQ(unescapedPrefix(""), 0);
+  EXPECT_EQ(unescapedPrefix("hello"), 5);
+  EXPECT_EQ(unescapedPrefix("hello\n"), 5);
+  EXPECT_EQ(unescapedPrefix("\"quoted\""), 0);
+  EXPECT_EQ(unescapedPrefix(std::string("ab\0cd", 5)), 2);
+  // Vertical tab and non-ASCII bytes are printed as-is.
+  EXPECT_EQ(unescapedPrefix("a\vb\x80\xff"), 5);
+
+  // Stops found by the vector kernels and by the scalar tail agree.
+  for (char Stop : {'\\', '"', '\a', '\b', '\t', '\n', '\f', '\r', '\0'}) {
+    for (size_t Pos : {0, 15, 16, 31, 32, 33, 70}) {
+      std::string S(80, 'x');
+      S[Pos] = Stop;
+      EXPECT_EQ(unescapedPrefix(S), Pos);
+    }
+  }
+  EXPECT_EQ(unescapedPrefix(std::string(80, 'x')), 80);
+}
+
+TEST(Unit_StringUtils, PrintablePrefix) {
+  EXPECT_EQ(printablePrefix(""), 0);
+  EXPECT_EQ(printablePrefix(" ~'hello'"), 9);
+  for (char Stop : {'\0', '\t', '\x1f', '\x7f', '\x80', '\xff'}) {
+    for (size_t Pos : {0, 15, 16, 31, 32, 33, 70}) {
+      std::string S(80, 'x');
+      S[Pos] = Stop;
+      EXPECT_EQ(printablePrefix(S), Pos);
+    }
+  }
+  EXPECT_EQ(printablePrefix(std::string(80, 'x')), 80);
+}
+
+TEST(Unit_StringUtils, ByteRunLength) {
+  // Whole runs, shorter than, equal to, and spanning the vector widths.
+  for (size_t Size : {0, 1, 15, 16, 31, 32, 33, 100}) {
+    std::vector<uint8_t> Bytes(Size, 0xab);
+    EXPECT_EQ(byte_run_length(Bytes.data(), Size, 0xab), Size);
+    EXPECT_EQ(byte_run_length(Bytes.data(), Size, 0xac), 0);
+  }
+
+  // A mismatch in every lane of the 16- and 32-byte kernels and of the tail.
+  for (size_t Pos = 0; Pos < 100; ++Pos) {
+    std::vector<uint8_t> Bytes(100, 0xab);
+    Bytes[Pos] = 0xba;
+    EXPECT_EQ(byte_run_length(Bytes.data(), Bytes.size(), 0xab), Pos);
+  }
+
+  // Unaligned start pointers.
+  std::vector<uint8_t> Bytes(128, 0x5a);
+  Bytes[100] = 0;
+  for (size_t Start = 0; Start < 32; ++Start) {
+    EXPECT_EQ(byte_run_length(Bytes.data() + Start, 60, 0x5a), 60);
+    EXPECT_EQ(byte_run_length(Bytes.data() + Start, 128 - Start, 0x5a),
+              100 - Start);
+  }
+
+  // A run of zeros ends at a non-zero byte, and non-zero runs at a zero byte.
+  std::vector<uint8_t> Zeros(40, 0);
+  Zeros[37] = 1;
+  EXPECT_EQ(byte_run_length(Zeros.data(), Zeros.size(), 0), 37);
+  EXPECT_EQ(byte_run_length(Zeros.data(), Zeros.size(), 1), 0);
+  std::vector<uint8_t> Ones(40, 1);
+  Ones[17] = 0;
+  EXPECT_EQ(byte_run_length(Ones.data(), Ones.size(), 1), 17);
+}
+
+TEST(Unit_StringUtils, WriteIntegers) {
+  std::ostringstream S;
+  // The stream's own flags are neither used nor changed.
+  S << std::hex;
+  write_dec(S, 1234);
+  S << ' ';
+  write_dec(S, int64_t(-42));
+  S << ' ';
+  write_dec(S, std::numeric_limits<uint64_t>::max());
+  S << ' ';
+  write_dec(S, std::numeric_limits<int64_t>::min());
+  S << ' ';
+  write_hex(S, 0);
+  S << ' ';
+  write_hex(S, 0xab, 4);
+  S << ' ';
+  write_hex(S, 0x123456789abcdef0);
+  S << ' ' << 255;
+  EXPECT_EQ(S.str(), "1234 -42 18446744073709551615 -9223372036854775808 0 "
+                     "00ab 123456789abcdef0 ff");
+}
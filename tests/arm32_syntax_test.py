@@ -1,7 +1,7 @@
 import gtirb
 
 from gtirb_helpers import add_code_block, add_text_section, create_test_module
-from pprinter_helpers import run_asm_pprinter, PPrinterTest
+from pprinter_helpers import asm_lines, run_asm_pprinter, PPrinterTest
 
 
 class Arm32InstructionsTest(PPrinterTest):
@@ -38,3 +38,45 @@ class Arm32InstructionsTest(PPrinterTest):
 
                 asm = run_asm_pprinter(ir)
                 self.assertIn(insn_str, asm)
+
+    def test_decode_mode_order(self):
+        """
+        Test that the blocks decoded earlier do not change how later Thumb
+        blocks print in a module that mixes M-profile and A-profile
+        instructions
+        """
+        msp = (b"\xef\xf3\x08\x80", "mrs r0, msp")  # M-profile only
+        blx = (b"\x00\xf0\x00\xe8", "blx")  # not on M-profile
+        mov = (b"\x08\x46", "mov r0, r1")  # any profile
+
+        def print_blocks(blocks):
+            ir, m = create_test_module(
+                file_format=gtirb.Module.FileFormat.ELF,
+                isa=gtirb.Module.ISA.ARM,
+            )
+            s, bi = add_text_section(m)
+            for insn_bytes, _ in blocks:
+                code_block = add_code_block(bi, insn_bytes)
+                code_block.decode_mode = gtirb.CodeBlock.DecodeMode.Thumb
+            return [
+                line
+                for line in asm_lines(run_asm_pprinter(ir))
+                if line.startswith(("mrs", "blx", "mov"))
+            ]
+
+        (expected,) = print_blocks([mov])
+        self.assertEqual(expected, mov[1])
+        orders = (
+            [msp] * 3 + [mov, blx, mov],
+            [blx] * 3 + [mov, msp, mov],
+        )
+        for blocks in orders:
+            with self.subTest(first=blocks[0][1]):
+                lines = print_blocks(blocks)
+                self.assertEqual(len(lines), len(blocks))
+                for line, (_, insn_str) in zip(lines, blocks):
+                    self.assertTrue(line.startswith(insn_str), line)
+                self.assertEqual(
+                    [line for line in lines if line.startswith("mov")],
+                    [expected, expected],
+                )
@@ -0,0 +1,61 @@
+import gtirb
+
+from gtirb_helpers import (
+    add_data_block,
+    add_data_section,
+    add_symbol,
+    create_test_module,
+)
+from pprinter_helpers import asm_lines, run_asm_pprinter, PPrinterTest
+
+
+class DataDirectiveTest(PPrinterTest):
+    def test_repeated_bytes(self):
+        """
+        Long runs of a repeated byte are printed with a single directive;
+        short runs are printed byte by byte.
+        """
+        ir, m = create_test_module(
+            file_format=gtirb.Module.FileFormat.ELF, isa=gtirb.Module.ISA.X64
+        )
+        _, bi = add_data_section(m)
+        add_data_block(
+            bi, b"\x01" + b"\x00" * 20 + b"\x02\x02" + b"\xff" * 16 + b"\x03"
+        )
+
+        asm = run_asm_pprinter(ir, ["--syntax", "intel"])
+        self.assertContains(
+            asm_lines(asm),
+            [
+                ".byte 0x1",
+                ".zero 20",
+                ".byte 0x2",
+                ".byte 0x2",
+                ".fill 16, 1, 0xff",
+                ".byte 0x3",
+            ],
+        )
+
+    def test_repeated_bytes_around_symbolic_expression(self):
+        """
+        Runs of a repeated byte end at symbolic expressions, and a block of
+        zeros with a symbolic expression past its start is not printed as a
+        single .zero directive.
+        """
+        ir, m = create_test_module(
+            file_format=gtirb.Module.FileFormat.ELF, isa=gtirb.Module.ISA.X64
+        )
+        _, bi = add_data_section(m)
+        target = add_data_block(bi, b"\x01")
+        sym = add_symbol(m, "target", target)
+        block = add_data_block(
+            bi, b"\x00" * 40, {16: gtirb.SymAddrConst(0, sym)}
+        )
+        m.aux_data["symbolicExpressionSizes"].data[
+            gtirb.Offset(bi, block.offset + 16)
+        ] = 8
+
+        asm = run_asm_pprinter(ir, ["--syntax", "intel"])
+        self.assertContains(
+            asm_lines(asm), [".zero 16", ".quad target", ".zero 16"]
+        )
@@ -1,8 +1,12 @@
 import os
+import re
+import shutil
 from pathlib import Path
 import subprocess
+import tempfile
 import typing
 import unittest
+import uuid
 
 import gtirb
 import gtirb_test_helpers as gth
@@ -12,6 +16,7 @@ import hello_world
 from pprinter_helpers import (
     BinaryPPrinterTest,
     run_asm_pprinter,
+    run_asm_pprinter_with_output,
     run_asm_pprinter_with_version_script,
 )
 
@@ -205,6 +210,88 @@ class ElfBinaryPrinterTests(BinaryPPrinterTest):
                 ("FUNC", "GLOBAL", "DEFAULT", "a@LIBA_2.0"),
             )
 
+    def test_dummyso_native(self):
+        """
+        Test printing GTIRBs with --dummy-so-native, which writes the dummy
+        libraries without invoking the compiler.
+        """
+        ir = dummyso.build_gtirb()
+        with self.binary_print(
+            ir, "--dummy-so", "yes", "--dummy-so-native", "yes"
+        ) as result:
+            libdir = Path(__file__).parent / "dummyso_libs"
+            subprocess.run("make", cwd=libdir, check=True)
+            exec_proc = subprocess.run(
+                str(result.path),
+                env={"LD_LIBRARY_PATH": libdir},
+                check=True,
+                capture_output=True,
+                text=True,
+            )
+            self.assertTrue("a() invoked!" in exec_proc.stdout)
+            self.assertTrue("b() invoked!" in exec_proc.stdout)
+
+        ir = dummyso.build_copy_relocated_gtirb()
+        with self.binary_print(
+            ir, "--dummy-so", "yes", "--dummy-so-native", "yes"
+        ) as result:
+            sym_addr, sym_addr_weak = self.assert_readelf_syms(
+                result.path,
+                ("OBJECT", "GLOBAL", "DEFAULT", "__lib_value"),
+                ("OBJECT", "WEAK", "DEFAULT", "__lib_value_weak"),
+            )
+            self.assertEqual(sym_addr, sym_addr_weak)
+
+        ir = dummyso.build_versioned_syms_gtirb()
+        with self.binary_print(
+            ir, "--dummy-so", "yes", "--dummy-so-native", "yes"
+        ) as result:
+            self.assert_readelf_syms(
+                result.path,
+                ("FUNC", "GLOBAL", "DEFAULT", "a@LIBA_1.0"),
+                ("FUNC", "GLOBAL", "DEFAULT", "a@LIBA_2.0"),
+            )
+
+    def test_dummyso_cache(self):
+        """
+        Test that --dummy-so-cache reuses the libraries generated by an
+        earlier run on the same IR.
+        """
+        ir = dummyso.build_gtirb()
+        libdir = Path(__file__).parent / "dummyso_libs"
+        subprocess.run("make", cwd=libdir, check=True)
+
+        with tempfile.TemporaryDirectory() as cache_dir:
+            args = ("--dummy-so", "yes", "--dummy-so-cache", cache_dir)
+            for run in ("miss", "hit"):
+                with self.subTest(run=run):
+                    with self.binary_print(ir, *args) as result:
+                        stdout = result.completed_process.stdout
+                        if run == "miss":
+                            self.assertNotIn("Using cached dummy .so", stdout)
+                            cached = sorted(os.listdir(cache_dir))
+                            self.assertEqual(len(cached), 2)
+                        else:
+                            self.assertIn(
+                                "Using cached dummy .so for libmya.so", stdout
+                            )
+                            self.assertIn(
+                                "Using cached dummy .so for libmyb.so", stdout
+                            )
+                            self.assertEqual(
+                                sorted(os.listdir(cache_dir)), cached
+                            )
+
+                        exec_proc = subprocess.run(
+                            str(result.path),
+                            env={"LD_LIBRARY_PATH": libdir},
+                            check=True,
+                            capture_output=True,
+                            text=True,
+                        )
+                        self.assertIn("a() invoked!", exec_proc.stdout)
+                        self.assertIn("b() invoked!", exec_proc.stdout)
+
     def test_dummyso_weak_versioned_sym_shared(self):
         """
         Test printing a GTIRB with --dummy-so where there are multiple external
@@ -423,6 +510,52 @@ class ElfBinaryPrinterTests(BinaryPPrinterTest):
             ("FUNC", "GLOBAL", "DEFAULT", "bar"),
         )
 
+    def test_fixup_cache(self):
+        """
+        Test that --fixup-cache replaces an invalid cache entry instead of
+        rewriting it in place, and that a hit prints the same assembly as a
+        miss
+        """
+        ir, module, text_bi = self.build_basic_ir()
+        # call foo, a global function that must be called through its hidden
+        # alias in a shared object.
+        foo_block = gth.add_code_block(text_bi, b"\xc3")
+        foo = gth.add_symbol(module, "foo", foo_block)
+        gth.add_code_block(
+            text_bi, b"\xe8\x00\x00\x00\x00", {1: gtirb.SymAddrConst(0, foo)}
+        )
+        module.aux_data["elfSymbolInfo"].data[foo.uuid] = (
+            0,
+            "FUNC",
+            "GLOBAL",
+            "DEFAULT",
+            0,
+        )
+
+        with tempfile.TemporaryDirectory() as cache_dir:
+            args = ["--shared=yes", "--fixup-cache", cache_dir]
+            miss, _ = run_asm_pprinter_with_output(ir, args)
+            (entry,) = os.listdir(cache_dir)
+            entry = os.path.join(cache_dir, entry)
+
+            # Corrupt the entry, keeping a second link to its file.
+            with open(entry, "w") as f:
+                f.write("not a patch\n")
+            saved = os.path.join(cache_dir, "saved")
+            os.link(entry, saved)
+
+            asm, output = run_asm_pprinter_with_output(ir, args)
+            self.assertIn("Ignoring invalid cached fixups", output)
+            self.assertEqual(asm, miss)
+            with open(saved) as f:
+                self.assertEqual(f.read(), "not a patch\n")
+            self.assertNotEqual(os.stat(entry).st_ino, os.stat(saved).st_ino)
+            os.remove(saved)
+
+            hit, output = run_asm_pprinter_with_output(ir, args)
+            self.assertIn("Using cached shared-object fixups", output)
+            self.assertEqual(hit, miss)
+
     def test_use_gcc(self):
         """
         Test --use-gcc, both with a gcc in PATH and with a full path to gcc
@@ -445,6 +578,58 @@ class ElfBinaryPrinterTests(BinaryPPrinterTest):
                     # Just verify binary_print succeeded.
                     pass
 
+    def test_use_ld(self):
+        """
+        Test --use-ld, with a linker that is always available, with automatic
+        detection, and with a linker that does not exist
+        """
+        ir = hello_world.build_gtirb()
+
+        with self.binary_print(ir, "--use-ld", "bfd") as result:
+            self.assertIn("Linking with bfd", result.completed_process.stdout)
+
+        with self.binary_print(ir, "--use-ld", "auto") as result:
+            stdout = result.completed_process.stdout
+            chosen = re.search(r"Linking with (\S+)", stdout)
+            if chosen:
+                self.assertIn(chosen.group(1), ("mold", "lld"))
+            else:
+                self.assertIn("No faster linker found", stdout)
+
+        with self.binary_print(ir, "--use-ld", "no-such-linker") as result:
+            self.assertIn(
+                "using the default linker", result.completed_process.stderr
+            )
+            self.assertNotIn("Linking with", result.completed_process.stdout)
+
+    @unittest.skipUnless(shutil.which("ld.lld"), "requires lld")
+    def test_use_ld_lld_keywords(self):
+        """
+        Test that lld is trusted with the -z keywords the printer emits, which
+        its --help output does not list individually, but not with others
+        """
+        ir = hello_world.build_gtirb()
+        with self.binary_print(
+            ir,
+            "--use-ld",
+            "lld",
+            "--compiler-args=-Wl,-z,noexecstack",
+        ) as result:
+            self.assertIn("Linking with lld", result.completed_process.stdout)
+            comment = self.readelf(result.path, "-p", ".comment").stdout
+            self.assertIn("LLD", comment)
+
+        with self.binary_print(
+            ir,
+            "--use-ld",
+            "lld",
+            "--compiler-args=-Wl,-z,relro",
+        ) as result:
+            self.assertIn(
+                "does not support '-z relro'", result.completed_process.stderr
+            )
+            self.assertNotIn("Linking with", result.completed_process.stdout)
+
     def test_object(self):
         """
         Test the --object argument
@@ -459,6 +644,250 @@ class ElfBinaryPrinterTests(BinaryPPrinterTest):
             )
             self.assertTrue("relocatable" in output.stdout)
 
+    def test_object_direct(self):
+        """
+        Test the --object-direct argument, which writes the object file
+        without invoking the assembler.
+        """
+        ir = hello_world.build_gtirb()
+        with self.binary_print(
+            ir, "--object", "--object-direct", "yes"
+        ) as result:
+            self.assertNotIn("falling back", result.completed_process.stderr)
+            header = self.readelf(result.path, "-h").stdout
+            self.assertRegex(header, r"Type:\s+REL")
+            relocs = self.readelf(result.path, "-r").stdout
+            self.assertRegex(relocs, r"R_X86_64_64\s+0+\s+hello \+ 0")
+
+    def build_object_direct_ir(self) -> gtirb.IR:
+        """
+        Build an IR that prints "hello world" and exits with status 5,
+        exercising PLT32, PC32 and GOTPCREL relocations, a SymAddrAddr that
+        the assembler folds, and CFI directives.
+        """
+        ir, module = gth.create_test_module(
+            gtirb.Module.FileFormat.ELF,
+            gtirb.Module.ISA.X64,
+        )
+        _, data_bi = gth.add_data_section(module, 0x402000)
+        _, text_bi = gth.add_text_section(module, 0x401000)
+
+        # call f
+        start_block = gth.add_code_block(text_bi, b"\xe8\x00\x00\x00\x00")
+        start = gth.add_symbol(module, "_start", start_block)
+
+        # Placeholders for the symbols referenced from f.
+        hello = gth.add_symbol(module, "hello")
+        status = gth.add_symbol(module, "status")
+
+        # For the following code:
+        #    48 8d 35 00 00 00 00    lea    hello(%rip),%rsi
+        #    b8 01 00 00 00          mov    $0x1,%eax
+        #    bf 01 00 00 00          mov    $0x1,%edi
+        #    ba 0c 00 00 00          mov    $0xc,%edx
+        #    0f 05                   syscall
+        #    48 8b 05 00 00 00 00    mov    status@GOTPCREL(%rip),%rax
+        #    8b 38                   mov    (%rax),%edi
+        #    b8 3c 00 00 00          mov    $0x3c,%eax
+        #    0f 05                   syscall
+        f_block = gth.add_code_block(
+            text_bi,
+            b"\x48\x8d\x35\x00\x00\x00\x00"
+            b"\xb8\x01\x00\x00\x00"
+            b"\xbf\x01\x00\x00\x00"
+            b"\xba\x0c\x00\x00\x00"
+            b"\x0f\x05"
+            b"\x48\x8b\x05\x00\x00\x00\x00"
+            b"\x8b\x38"
+            b"\xb8\x3c\x00\x00\x00"
+            b"\x0f\x05",
+            {
+                3: gtirb.SymAddrConst(0, hello),
+                27: gtirb.SymAddrConst(
+                    0,
+                    status,
+                    {
+                        gtirb.SymbolicExpression.Attribute.GOT,
+                        gtirb.SymbolicExpression.Attribute.PCREL,
+                    },
+                ),
+            },
+        )
+        f = gth.add_symbol(module, "f", f_block)
+        text_bi.symbolic_expressions[start_block.offset + 1] = (
+            gtirb.SymAddrConst(0, f)
+        )
+
+        hello_block = gth.add_data_block(data_bi, b"hello world\n")
+        hello.referent = hello_block
+        # status: .long f - _start
+        status_block = gth.add_data_block(
+            data_bi,
+            b"\x00\x00\x00\x00",
+            {0: gtirb.SymAddrAddr(1, 0, f, start)},
+        )
+        status.referent = status_block
+        module.aux_data["symbolicExpressionSizes"].data[
+            gtirb.Offset(data_bi, status_block.offset)
+        ] = 4
+
+        cfi = module.aux_data["cfiDirectives"].data
+        cfi[gtirb.Offset(start_block, 0)] = [
+            (".cfi_startproc", [], uuid.UUID(int=0))
+        ]
+        cfi[gtirb.Offset(f_block, f_block.size)] = [
+            (".cfi_endproc", [], uuid.UUID(int=0))
+        ]
+
+        for sym, block, type in (
+            (start, start_block, "FUNC"),
+            (f, f_block, "FUNC"),
+            (hello, hello_block, "OBJECT"),
+            (status, status_block, "OBJECT"),
+        ):
+            module.aux_data["elfSymbolInfo"].data[sym.uuid] = (
+                block.size,
+                type,
+                "GLOBAL",
+                "DEFAULT",
+                0,
+            )
+        return ir
+
+    def test_object_direct_binary(self):
+        """
+        Test that a binary linked from a directly written object runs.
+        """
+        ir = self.build_object_direct_ir()
+        with self.binary_print(ir, "--object-direct", "yes") as result:
+            self.assertNotIn("falling back", result.completed_process.stderr)
+            output = subprocess.run(
+                [result.path], capture_output=True, text=True
+            )
+            self.assertEqual(output.stdout, "hello world\n")
+            self.assertEqual(output.returncode, 5)
+
+    def read_object(self, path: Path) -> typing.Dict[str, typing.Any]:
+        """
+        Summarize the parts of an object file that the assembler and the
+        direct object writer should agree on.
+        """
+        relocs = {}
+        section = None
+        for line in self.readelf(path, "-rW").stdout.splitlines():
+            match = re.match(r"Relocation section '([^']+)'", line)
+            if match:
+                section = match.group(1)
+                relocs[section] = []
+                continue
+            fields = line.split()
+            if section and fields and fields[0].startswith("0"):
+                # The assembler marks GOT loads as relaxable; the writer
+                # does not.
+                type = re.sub(
+                    r"R_X86_64_(REX_)?GOTPCRELX",
+                    "R_X86_64_GOTPCREL",
+                    fields[2],
+                )
+                # Skip the symbol value, which depends on symbol order.
+                relocs[section].append(
+                    (int(fields[0], 16), type, " ".join(fields[4:]))
+                )
+
+        frames = self.readelf(path, "--debug-dump=frames").stdout
+        fde_ranges = [
+            int(end, 16) - int(start, 16)
+            for start, end in re.findall(
+                r"FDE cie=\S+ pc=([0-9a-f]+)\.\.([0-9a-f]+)", frames
+            )
+        ]
+        return {
+            "relocs": {
+                name: entries
+                for name, entries in relocs.items()
+                if name != ".rela.eh_frame"
+            },
+            "text": self.readelf(path, "-x", ".text").stdout,
+            "data": self.readelf(path, "-x", ".data").stdout,
+            "fde_ranges": fde_ranges,
+        }
+
+    def test_object_direct_matches_assembler(self):
+        """
+        Test that the direct object writer produces the same relocations,
+        section contents and frame descriptions as the assembler.
+        """
+        ir = self.build_object_direct_ir()
+        with self.binary_print(ir, "--object") as result:
+            expected = self.read_object(result.path)
+        with self.binary_print(
+            ir, "--object", "--object-direct", "yes"
+        ) as result:
+            self.assertNotIn("falling back", result.completed_process.stderr)
+            actual = self.read_object(result.path)
+
+        self.assertEqual(
+            expected["relocs"][".rela.text"],
+            [
+                (1, "R_X86_64_PLT32", "f - 4"),
+                (8, "R_X86_64_PC32", "hello - 4"),
+                (32, "R_X86_64_GOTPCREL", "status - 4"),
+            ],
+        )
+        # f - _start is resolved by the assembler.
+        self.assertNotIn(".rela.data", expected["relocs"])
+        self.assertEqual(expected["fde_ranges"], [45])
+        self.assertEqual(actual, expected)
+
+    def test_object_direct_plt_operand(self):
+        """
+        Test that @PLT on a PC-relative operand that is not a branch gets
+        the same relocation from the direct object writer as from the
+        assembler.
+        """
+        ir, module = gth.create_test_module(
+            gtirb.Module.FileFormat.ELF,
+            gtirb.Module.ISA.X64,
+        )
+        _, bi = gth.add_text_section(module, 0x401000)
+
+        # For the following code:
+        #    48 8d 05 00 00 00 00    lea    f@PLT(%rip),%rax
+        #    c3                      ret
+        start_block = gth.add_code_block(
+            bi, b"\x48\x8d\x05\x00\x00\x00\x00\xc3"
+        )
+        start = gth.add_symbol(module, "_start", start_block)
+        # f: ret
+        f_block = gth.add_code_block(bi, b"\xc3")
+        f = gth.add_symbol(module, "f", f_block)
+        bi.symbolic_expressions[start_block.offset + 3] = gtirb.SymAddrConst(
+            0, f, {gtirb.SymbolicExpression.Attribute.PLT}
+        )
+        for sym, block in ((start, start_block), (f, f_block)):
+            module.aux_data["elfSymbolInfo"].data[sym.uuid] = (
+                block.size,
+                "FUNC",
+                "GLOBAL",
+                "DEFAULT",
+                0,
+            )
+
+        with self.binary_print(ir, "--object") as result:
+            expected = self.read_object(result.path)
+        with self.binary_print(
+            ir, "--object", "--object-direct", "yes"
+        ) as result:
+            self.assertNotIn("falling back", result.completed_process.stderr)
+            actual = self.read_object(result.path)
+
+        self.assertEqual(
+            expected["relocs"][".rela.text"],
+            [(3, "R_X86_64_PLT32", "f - 4")],
+        )
+        self.assertEqual(actual["relocs"], expected["relocs"])
+        self.assertEqual(actual["text"], expected["text"])
+
     def subtest_dyn_option(
         self,
         mode: str,
@@ -0,0 +1,74 @@
+import os
+import subprocess
+import unittest
+
+import gtirb
+
+from gtirb_helpers import add_data_block, add_section, create_test_module
+from pprinter_helpers import layout_binary, temp_directory
+
+
+class LayoutDriverTests(unittest.TestCase):
+    def build_overlapping_ir(self, name: str) -> gtirb.IR:
+        """
+        Build an IR whose module has two sections at the same address.
+        """
+        ir, m = create_test_module(
+            gtirb.Module.FileFormat.ELF, gtirb.Module.ISA.X64
+        )
+        m.name = name
+        for section in (".data1", ".data2"):
+            _, bi = add_section(m, section, address=0x1000)
+            add_data_block(bi, b"\x00" * 16)
+        return ir
+
+    def run_layout(self, *args) -> subprocess.CompletedProcess:
+        return subprocess.run(
+            [layout_binary(), *args],
+            capture_output=True,
+            text=True,
+        )
+
+    def assert_no_overlap(self, m: gtirb.Module):
+        intervals = sorted(m.byte_intervals, key=lambda bi: bi.address)
+        for prev, bi in zip(intervals, intervals[1:]):
+            self.assertLessEqual(prev.address + prev.size, bi.address)
+
+    def test_batch(self):
+        """
+        Test laying out several files, paired by position, in one run
+        """
+        with temp_directory() as tmpdir:
+            inputs = []
+            outputs = []
+            for name in ("first", "second"):
+                path = os.path.join(tmpdir, name + ".gtirb")
+                self.build_overlapping_ir(name).save_protobuf(path)
+                inputs.append(path)
+                outputs.append(os.path.join(tmpdir, name + "-out.gtirb"))
+
+            proc = self.run_layout("--in", *inputs, "--out", *outputs)
+            self.assertEqual(proc.returncode, 0, proc.stdout)
+
+            for name, output in zip(("first", "second"), outputs):
+                ir = gtirb.IR.load_protobuf(output)
+                (m,) = ir.modules
+                self.assertEqual(m.name, name)
+                self.assert_no_overlap(m)
+
+    def test_mismatched_counts(self):
+        """
+        Test that each input file needs an output file
+        """
+        with temp_directory() as tmpdir:
+            inputs = []
+            for name in ("first", "second"):
+                path = os.path.join(tmpdir, name + ".gtirb")
+                self.build_overlapping_ir(name).save_protobuf(path)
+                inputs.append(path)
+            output = os.path.join(tmpdir, "out.gtirb")
+
+            proc = self.run_layout("--in", *inputs, "--out", output)
+            self.assertNotEqual(proc.returncode, 0)
+            self.assertIn("Expected one output file", proc.stdout)
+            self.assertFalse(os.path.exists(output))
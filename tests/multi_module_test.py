@@ -100,6 +100,41 @@ class MultiModuleTests(PPrinterTest):
             self.assertNotIn(".globl main", output)
             self.assertIn(".globl fun", output)
 
+    def test_multiple_pe_modules_stdout_integral_symbol(self):
+        """
+        Test that printing a MASM integral symbol, which is written in hex,
+        does not leave later numbers on the same stream in hex.
+        """
+        ir = gtirb.IR()
+        for name in ("first.exe", "second.exe"):
+            m = gtirb.Module(
+                name=name,
+                file_format=gtirb.Module.FileFormat.PE,
+                isa=gtirb.Module.ISA.X64,
+            )
+            m.ir = ir
+            add_standard_aux_data_tables(m)
+            _, bi = add_section(m, ".data", address=0x1000)
+            data = add_data_block(bi, b"\x00" * 20)
+            m.aux_data["alignment"].data[data] = 16
+            sym = gtirb.Symbol("integral", payload=0x10000)
+            sym.module = m
+
+        with temp_directory() as tmpdir:
+            gtirb_path = os.path.join(tmpdir, "test.gtirb")
+            ir.save_protobuf(gtirb_path)
+
+            output = subprocess.check_output(
+                (pprinter_binary(), "--ir", gtirb_path),
+                cwd=tmpdir,
+            ).decode(sys.stdout.encoding)
+
+        lines = [line.strip() for line in output.splitlines()]
+        self.assertEqual(lines.count("integral = 10000H"), 2)
+        self.assertEqual(lines.count("DB 20 DUP(0)"), 2)
+        self.assertIn("ALIGN 16", lines)
+        self.assertNotIn("ALIGN 10", lines)
+
     @unittest.skipUnless(can_mock_binaries(), "cannot mock binaries")
     def test_multiple_modules_binary(self):
         """
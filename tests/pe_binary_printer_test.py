@@ -3,6 +3,7 @@ import platform
 from pathlib import Path
 import subprocess
 import sys
+import tempfile
 import unittest
 import uuid
 
@@ -104,6 +105,69 @@ class WindowsBinaryPrinterTests(PPrinterTest):
         else:
             self.fail("did not see a lib.exe execution")
 
+    def test_windows_import_libs_before_link(self):
+        """
+        Test that each import library is built, possibly concurrently, before
+        the step that links against them starts
+        """
+        ir, m = create_test_module(
+            file_format=gtirb.Module.FileFormat.PE,
+            isa=gtirb.Module.ISA.X64,
+            binary_type=["EXEC", "EXE", "WINDOWS_CUI"],
+        )
+        dlls = ("USER32.DLL", "KERNEL32.DLL", "GDI32.DLL")
+        for i, dll in enumerate(dlls):
+            m.aux_data["peImportEntries"].data.append(
+                (0, -1, "Function{}".format(i), dll)
+            )
+
+        tools = [tool.name for tool in run_binary_pprinter_mock(ir)]
+        self.assertEqual(tools, ["lib.exe"] * len(dlls) + ["ml64.exe"])
+
+    def test_windows_import_lib_cache(self):
+        """
+        Test that --import-lib-cache skips the librarian on a cache hit, and
+        that the library it leaves for the user is a copy of the cached one
+        """
+        ir, m = create_test_module(
+            file_format=gtirb.Module.FileFormat.PE,
+            isa=gtirb.Module.ISA.X64,
+            binary_type=["EXEC", "EXE", "WINDOWS_CUI"],
+        )
+        m.aux_data["peImportEntries"].data.append(
+            (0, -1, "GetMessageW", "USER32.DLL")
+        )
+
+        with tempfile.TemporaryDirectory() as cache_dir:
+            args = ("--import-lib-cache", cache_dir)
+
+            # Miss: the fake librarian writes nothing, so write the library
+            # while it runs.
+            tools = []
+            for tool in run_binary_pprinter_mock(ir, args):
+                tools.append(tool.name)
+                if tool.name == "lib.exe":
+                    out_arg = next(
+                        arg for arg in tool.args if arg.startswith("/OUT:")
+                    )
+                    lib = os.path.join(tool.cwd, out_arg[5:])
+                    with open(lib, "wb") as f:
+                        f.write(b"import library")
+            self.assertIn("lib.exe", tools)
+            self.assertEqual(len(os.listdir(cache_dir)), 1)
+
+            # Hit: the library is placed without running the librarian.
+            tools = []
+            for tool in run_binary_pprinter_mock(ir, args):
+                tools.append(tool.name)
+                if tool.name == "ml64.exe":
+                    lib = os.path.join(tool.cwd, "USER32.lib")
+                    with open(lib, "rb") as f:
+                        self.assertEqual(f.read(), b"import library")
+                    self.assertEqual(os.stat(lib).st_nlink, 1)
+            self.assertNotIn("lib.exe", tools)
+            self.assertIn("ml64.exe", tools)
+
     def test_windows_defs_with_llvm(self):
         """
         Check that:
@@ -88,6 +88,13 @@ def pprinter_binary() -> str:
     return os.environ.get("PPRINTER_PATH", "gtirb-pprinter")
 
 
+def layout_binary() -> str:
+    """
+    The binary to invoke to test the layout driver.
+    """
+    return os.environ.get("LAYOUT_PATH", "gtirb-layout")
+
+
 def running_in_pytest() -> bool:
     """
     Determines if the test is running under pytest.
@@ -271,9 +278,9 @@ def run_binary_pprinter_mock(
         # of spurious wakeups on this thread.
         listener.settimeout(0.01)
 
-        # The pretty-printer invokes processes synchronously and serially,
-        # so we don't need to get clever about multiple connections at
-        # once (or the ordering of things).
+        # Connections are served one at a time. The pretty-printer may run
+        # independent processes concurrently; those wait in the backlog, so
+        # invocations are yielded in the order they started.
         generator_exit = False
         while not proc_future.done():
             try: